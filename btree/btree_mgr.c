@@ -15,6 +15,9 @@
 */
 
 
+// pthread_rwlock_t in ds_define.h is hidden by a strict -std=c99 build
+#define _XOPEN_SOURCE 700
+
 // user-defined libraries
 #include "storage_mgr.h"
 #include "record_mgr.h"
@@ -28,7 +31,7 @@
 
 
 int checkVal = 6;
-SM_FileHandle fh;
+static SM_FileHandle fh;
 BTreeNode *rootNode, *curr;
 int highestElement, idxNumber, MAX_KEYS_PER_NODE;
 
@@ -36,8 +36,8 @@ typedef int RC;
 #define RC_INVALID_PAGE_RANGE 95
 #define RC_BUFFER_POOL_INITIALIZE_ERROR 94
 #define RC_INVALID_STRATEGY 93
-#define RC_EMPTY_QUEUE 92;
-#define RC_FULL_BUFFER 91;
+#define RC_EMPTY_QUEUE 92
+#define RC_FULL_BUFFER 91
 
 #define RC_RM_COMPARE_VALUE_OF_DIFFERENT_DATATYPE 200
 #define RC_RM_EXPR_RESULT_IS_NOT_BOOLEAN 201
@@ -61,10 +61,15 @@ typedef int RC;
 #define RC_INVALID_PAGE_NUM 83
 #define RC_MELLOC_MEM_ALLOC_FAILED 82
 #define RC_SCHEMA_NOT_INIT 81
-#define RC_INVALID_REFERENCE_TO_FILE 80;
-#define RC_NULL 79;
-#define RC_READ_FAILED 78;
-#define RC_MISC_ERROR 77;
+#define RC_INVALID_REFERENCE_TO_FILE 80
+#define RC_NULL 79
+#define RC_READ_FAILED 78
+#define RC_MISC_ERROR 77
+#define RC_MAP_FAILED 76
+#define RC_INVALID_PAGE_SIZE 75
+#define RC_INVALID_PAGE_FILE 74
+#define RC_FREE_PAGE_FAILED 73
+#define RC_CHECKSUM_MISMATCH 72
 
 /* holder for error messages */
 extern char *RC_message;
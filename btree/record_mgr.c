@@ -1,3 +1,6 @@
+// pthread_rwlock_t in ds_define.h is hidden by a strict -std=c99 build
+#define _XOPEN_SOURCE 700
+
 #include <stdlib.h>
 #include <string.h>
 #include "record_mgr.h"
@@ -12,6 +15,7 @@ SM_FileHandle fh;
 SM_PageHandle ph;
 TableManagement tableManagement;
 ScanManagement scanManagement;
+int tombstonedRIDs[MAX_TOMBSTONED_RIDS];
 
 /**
  * 
@@ -115,6 +119,12 @@ RC createTable(char *name, Schema *schema)
         }else{
             return 1;
         }
+
+        status = closePageFile(&fh);
+        if (status != RC_OK)
+        {
+            return 1;
+        }
         
         return RC_OK;
     }
@@ -573,18 +583,16 @@ RC updateRecord(RM_TableData *rel, Record *record)
 
 /**
  * 
- * This fucntion will retrieve a record from a table based on its RID. 
- * It will first pin the appropriate page, then copy the record's data 
- * into the Record struct. It will also set the record's ID to the given RID. 
- * Finally, it will unpin the page and return an appropriate status code.
+ * This function reads a record into the Record struct, pinning its page
+ * with the given access hint.
  * 
 */
-RC getRecord(RM_TableData *rel, RID id, Record *record)
+static RC readRecord(RID id, Record *record, BM_AccessHint hint)
 {
     BM_PageHandle *page = &tableManagement.pageHandle;
     BM_BufferPool *bm = &tableManagement.bufferPool;
 
-    if (pinPage(bm, page, id.page) == RC_OK)
+    if (pinPageWithHint(bm, page, id.page, hint) == RC_OK)
     {
         int recordOffset = id.slot * tableManagement.recordSize;                     // this will give starting point of record. remember last value in record is '$' replce it wil
         memcpy(record->data, page->data + recordOffset, tableManagement.recordSize); // case of error check boundry condition also check for reccord->data size
@@ -600,6 +608,19 @@ RC getRecord(RM_TableData *rel, RID id, Record *record)
     return unpinPage(bm, page) == RC_OK ? RC_OK : RC_UNPIN_PAGE_FAILED;
 }
 
+/**
+ * 
+ * This fucntion will retrieve a record from a table based on its RID. 
+ * It will first pin the appropriate page, then copy the record's data 
+ * into the Record struct. It will also set the record's ID to the given RID. 
+ * Finally, it will unpin the page and return an appropriate status code.
+ * 
+*/
+RC getRecord(RM_TableData *rel, RID id, Record *record)
+{
+    return readRecord(id, record, BM_HINT_NORMAL);
+}
+
 /**
  * 
  * This function will start a scan operation on a table based on a given condition. 
@@ -625,7 +646,8 @@ RC startScan(RM_TableData *rel, RM_ScanHandle *scan, Expr *condition)
 /**
  * 
  * This function will retrieve the next record that satisfies the given condition of an 
- * ongoing scan, starting from the current record's page and slot till the last record is encountered
+ * ongoing scan, starting from the current record's page and slot till the last record is encountered.
+ * The pages are pinned as a sequential scan, so they cycle through the scan ring of the buffer pool.
  * 
 */
 RC next(RM_ScanHandle *scan, Record *record)
@@ -653,7 +675,7 @@ RC next(RM_ScanHandle *scan, Record *record)
     {
         scanManagement.recordID.page = curPageScan?curPageScan:0;
         scanManagement.recordID.slot = curSlotScan?curSlotScan:0;
-        RC_message = getRecord(scan->rel, scanManagement.recordID, record) == RC_OK?RC_message: "Reading the record was unsuccessful";
+        RC_message = readRecord(scanManagement.recordID, record, BM_HINT_SEQUENTIAL) == RC_OK?RC_message: "Reading the record was unsuccessful";
 
         evalExpr(record, (scan->rel)->schema, scanManagement.condition, &queryExpResult);
         if (scanManagement.condition && queryExpResult->v.boolV == true)
@@ -1223,7 +1245,7 @@ void schemaReadFromFile(RM_TableData *rel, BM_PageHandle *h)
              tableManagement.recordSize = n;
         }
 
-        RC n = (PAGE_SIZE / tableManagement.recordSize);
+        RC n = (getPoolPageSize(&tableManagement.bufferPool) / tableManagement.recordSize);
         tableManagement.blockFactor = n;
 
         tableManagement.firstFreeLoc.page = pageSolt[0];
@@ -35,8 +35,13 @@ typedef int RC;
 #define RC_INVALID_PAGE_RANGE 95
 #define RC_BUFFER_POOL_INITIALIZE_ERROR 94
 #define RC_INVALID_STRATEGY 93
-#define RC_EMPTY_QUEUE 92;
-#define RC_FULL_BUFFER 91;
+#define RC_EMPTY_QUEUE 92
+#define RC_FULL_BUFFER 91
+#define RC_MAP_FAILED 76
+#define RC_INVALID_PAGE_SIZE 75
+#define RC_INVALID_PAGE_FILE 74
+#define RC_FREE_PAGE_FAILED 73
+#define RC_CHECKSUM_MISMATCH 72
 
 /* holder for error messages */
 extern char *RC_message;
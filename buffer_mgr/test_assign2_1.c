@@ -1,3 +1,6 @@
+// nanosleep is hidden by a strict -std=c99 build
+#define _XOPEN_SOURCE 700
+
 #include "storage_mgr.h"
 #include "buffer_mgr_stat.h"
 #include "buffer_mgr.h"
@@ -7,6 +10,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
+#include <time.h>
 
 // var to store the current test's name
 char *testName;
@@ -37,6 +42,24 @@ static void testReadPage (void);
 
 static void testFIFO (void);
 static void testLRU (void);
+static void testCLOCK (void);
+static void testLRUK (void);
+static void testLFU (void);
+static void testARC (void);
+static void test2Q (void);
+static void testFrameReuse (void);
+static void testDirectIO (void);
+static void testPageTable (void);
+static void testMultiplePools (void);
+static void testConcurrentPins (void);
+static void testBackgroundWriter (void);
+static void testPinTimeout (void);
+static void testScanRing (void);
+static void testReadAhead (void);
+static void testBatchPins (void);
+static void testPoolStats (void);
+static void testLatencyStats (void);
+static void testChecksumMismatch (void);
 
 // main method
 int
@@ -49,6 +72,24 @@ main (void)
   testReadPage();
   testFIFO();
   testLRU();
+  testCLOCK();
+  testLRUK();
+  testLFU();
+  testARC();
+  test2Q();
+  testFrameReuse();
+  testDirectIO();
+  testPageTable();
+  testMultiplePools();
+  testConcurrentPins();
+  testBackgroundWriter();
+  testPinTimeout();
+  testScanRing();
+  testReadAhead();
+  testBatchPins();
+  testPoolStats();
+  testLatencyStats();
+  testChecksumMismatch();
 }
 
 // create n pages with content "Page X" and read them back to check whether the content is right
@@ -300,3 +341,1204 @@ testLRU (void)
   free(h);
   TEST_DONE();
 }
+
+// test the CLOCK page replacement strategy
+void
+testCLOCK (void)
+{
+  // expected results
+  const char *poolContents[] = {
+    "[0 0],[-1 0],[-1 0]",
+    "[0 0],[1 0],[-1 0]",
+    "[0 0],[1 0],[2 0]",
+    // every frame has its reference bit set, the hand clears them all and comes back to frame 0
+    "[3 0],[1 0],[2 0]",
+    // a hit only sets the reference bit of page 1
+    "[3 0],[1 0],[2 0]",
+    "[3 0],[1 0],[4 0]",
+    // page 3 gets a second chance, page 1 has used up its own
+    "[3 0],[5 0],[4 0]",
+    // the pinned page 4 is skipped
+    "[6 0],[5 0],[4 1]"
+  };
+  const int requests[] = {0,1,2,3,1,4,5};
+  const int numRequests = 7;
+
+  int i;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  testName = "Testing CLOCK page replacement";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  createDummyPages(bm, 100);
+  CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_CLOCK, NULL));
+
+  for(i = 0; i < numRequests; i++)
+    {
+      pinPage(bm, h, requests[i]);
+      unpinPage(bm, h);
+      ASSERT_EQUALS_POOL(poolContents[i], bm, "check pool content");
+    }
+
+  CHECK(pinPage(bm, h, 4));
+  CHECK(pinPage(bm, h, 6));
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL(poolContents[i], bm, "check pool content with a pinned page");
+  h->pageNum = 4;
+  CHECK(unpinPage(bm, h));
+
+  ASSERT_EQUALS_INT(0, getNumWriteIO(bm), "check number of write I/Os");
+  ASSERT_EQUALS_INT(7, getNumReadIO(bm), "check number of read I/Os");
+
+  CHECK(shutdownBufferPool(bm));
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// test the LRU-K page replacement strategy with K = 2
+void
+testLRUK (void)
+{
+  // expected results
+  const char *poolContents[] = {
+    "[0 0],[-1 0],[-1 0]",
+    "[0 0],[-1 0],[-1 0]",
+    "[0 0],[1 0],[-1 0]",
+    "[0 0],[1 0],[2 0]",
+    // pages 1 and 2 were only used once, page 0 twice
+    "[0 0],[3 0],[2 0]",
+    "[0 0],[3 0],[4 0]",
+    // the pinned page 0 is not replaced
+    "[0 1],[5 0],[4 0]",
+    // with a correlated reference period of 2 the second access to page 0 does not count
+    "[3 0],[1 0],[2 0]"
+  };
+  const int requests[] = {0,0,1,2,3,4};
+  const int numRequests = 6;
+
+  int i;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_LRUKParams params = { .k = 2, .correlatedPeriod = 0 };
+  testName = "Testing LRU-K page replacement";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  createDummyPages(bm, 100);
+  CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_LRU_K, &params));
+
+  for(i = 0; i < numRequests; i++)
+    {
+      pinPage(bm, h, requests[i]);
+      unpinPage(bm, h);
+      ASSERT_EQUALS_POOL(poolContents[i], bm, "check pool content");
+    }
+
+  CHECK(pinPage(bm, h, 0));
+  CHECK(pinPage(bm, h, 5));
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL(poolContents[i++], bm, "check pool content with a pinned page");
+  h->pageNum = 0;
+  CHECK(unpinPage(bm, h));
+
+  ASSERT_EQUALS_INT(0, getNumWriteIO(bm), "check number of write I/Os");
+  ASSERT_EQUALS_INT(6, getNumReadIO(bm), "check number of read I/Os");
+  CHECK(shutdownBufferPool(bm));
+
+  params.correlatedPeriod = 2;
+  CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_LRU_K, &params));
+  for(int j = 0; j < 5; j++)
+    {
+      pinPage(bm, h, requests[j]);
+      unpinPage(bm, h);
+    }
+  ASSERT_EQUALS_POOL(poolContents[i], bm, "check pool content with a correlated reference period");
+
+  CHECK(shutdownBufferPool(bm));
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// test the LFU page replacement strategy, with and without aging
+void
+testLFU (void)
+{
+  // expected results
+  const char *poolContents[] = {
+    "[0 0],[-1 0],[-1 0]",
+    "[0 0],[-1 0],[-1 0]",
+    "[0 0],[-1 0],[-1 0]",
+    "[0 0],[1 0],[-1 0]",
+    "[0 0],[1 0],[-1 0]",
+    "[0 0],[1 0],[2 0]",
+    // page 2 was used least often
+    "[0 0],[1 0],[3 0]",
+    "[0 0],[1 0],[4 0]",
+    // halving the frequencies every 4 pins lets the once hot page 0 go
+    "[4 0],[3 0],[2 0]",
+    // halving after 6 pins merges page 0 into the bucket of page 1, and page 0 was pinned last before page 1
+    "[4 0],[1 0],[3 0]"
+  };
+  const int requests[] = {0,0,0,1,1,2,3,4};
+  const int numRequests = 8;
+  const int agingRequests[] = {0,0,0,1,2,3,4};
+
+  int i;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_LFUParams params = { .agingPeriod = 1000 };
+  testName = "Testing LFU page replacement";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  createDummyPages(bm, 100);
+  CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_LFU, &params));
+
+  for(i = 0; i < numRequests; i++)
+    {
+      pinPage(bm, h, requests[i]);
+      unpinPage(bm, h);
+      ASSERT_EQUALS_POOL(poolContents[i], bm, "check pool content");
+    }
+
+  ASSERT_EQUALS_INT(0, getNumWriteIO(bm), "check number of write I/Os");
+  ASSERT_EQUALS_INT(5, getNumReadIO(bm), "check number of read I/Os");
+  CHECK(shutdownBufferPool(bm));
+
+  params.agingPeriod = 4;
+  CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_LFU, &params));
+  for(int j = 0; j < 7; j++)
+    {
+      pinPage(bm, h, agingRequests[j]);
+      unpinPage(bm, h);
+    }
+  ASSERT_EQUALS_POOL(poolContents[i], bm, "check pool content with aging");
+  CHECK(shutdownBufferPool(bm));
+
+  params.agingPeriod = 6;
+  CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_LFU, &params));
+  for(int j = 0; j < numRequests; j++)
+    {
+      pinPage(bm, h, requests[j]);
+      unpinPage(bm, h);
+    }
+  ASSERT_EQUALS_POOL(poolContents[i + 1], bm, "check pool content after merging buckets oldest first");
+
+  CHECK(shutdownBufferPool(bm));
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// pin and unpin each page of requests once
+static void
+pinRequests (BM_BufferPool *bm, BM_PageHandle *h, const int *requests, int numRequests)
+{
+  int i;
+  for(i = 0; i < numRequests; i++)
+    {
+      pinPage(bm, h, requests[i]);
+      unpinPage(bm, h);
+    }
+}
+
+// test that ARC keeps pages used twice through a scan and adapts to ghost hits
+void
+testARC (void)
+{
+  const int hotPages[] = {0,0,1,1};
+  const int scan[] = {10,11,12,13,14,15,16,17,18,19};
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  testName = "Testing ARC page replacement";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  createDummyPages(bm, 100);
+  CHECK(initBufferPool(bm, "testbuffer.bin", 4, RS_ARC, NULL));
+
+  pinRequests(bm, h, hotPages, 4);
+  pinRequests(bm, h, scan, 10);
+  ASSERT_EQUALS_POOL("[0 0],[1 0],[18 0],[19 0]", bm, "the scan only replaces pages seen once");
+
+  // page 17 left the pool recently, asking for it again makes room for pages seen once
+  pinRequests(bm, h, &scan[7], 1);
+  ASSERT_EQUALS_POOL("[0 0],[1 0],[17 0],[19 0]", bm, "a ghost hit is loaded as a page seen again");
+
+  CHECK(pinPage(bm, h, 0));
+  CHECK(pinPage(bm, h, 1));
+  CHECK(pinPage(bm, h, 17));
+  CHECK(pinPage(bm, h, 19));
+  ASSERT_ERROR(pinPage(bm, h, 20), "no frame is free when all pages are pinned");
+  h->pageNum = 0;
+  CHECK(unpinPage(bm, h));
+  h->pageNum = 1;
+  CHECK(unpinPage(bm, h));
+  h->pageNum = 17;
+  CHECK(unpinPage(bm, h));
+  h->pageNum = 19;
+  CHECK(unpinPage(bm, h));
+
+  ASSERT_EQUALS_INT(0, getNumWriteIO(bm), "check number of write I/Os");
+  ASSERT_EQUALS_INT(13, getNumReadIO(bm), "check number of read I/Os");
+
+  CHECK(shutdownBufferPool(bm));
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// test that 2Q promotes pages asked for again after they left the FIFO queue and keeps them through a scan
+void
+test2Q (void)
+{
+  const int requests[] = {0,1,2,3,4,0,1};
+  const int scan[] = {10,11,12,13,14,15};
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  testName = "Testing 2Q page replacement";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  createDummyPages(bm, 100);
+  CHECK(initBufferPool(bm, "testbuffer.bin", 4, RS_2Q, NULL));
+
+  pinRequests(bm, h, requests, 7);
+  ASSERT_EQUALS_POOL("[4 0],[0 0],[1 0],[3 0]", bm, "pages 0 and 1 come back into the main queue");
+  pinRequests(bm, h, scan, 6);
+  ASSERT_EQUALS_POOL("[15 0],[0 0],[1 0],[14 0]", bm, "the scan only replaces pages of the FIFO queue");
+
+  ASSERT_EQUALS_INT(0, getNumWriteIO(bm), "check number of write I/Os");
+  ASSERT_EQUALS_INT(13, getNumReadIO(bm), "check number of read I/Os");
+
+  CHECK(shutdownBufferPool(bm));
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// test that pages are always loaded into the frames the pool was created with
+void
+testFrameReuse (void)
+{
+  int i, j;
+  char *frames[3];
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  testName = "Testing frame reuse";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  createDummyPages(bm, 100);
+  CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_LRU, NULL));
+
+  for (i = 0; i < 3; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      frames[i] = h->data;
+      CHECK(unpinPage(bm, h));
+    }
+  ASSERT_TRUE(frames[1] - frames[0] == PAGE_SIZE && frames[2] - frames[1] == PAGE_SIZE, "frames are laid out in one arena");
+
+  for (i = 3; i < 100; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      for (j = 0; j < 3 && frames[j] != h->data; j++)
+        ;
+      ASSERT_TRUE(j < 3, "page is loaded into one of the pool's frames");
+      ASSERT_TRUE(h->data[0] != '\0', "page is read into the frame");
+      CHECK(unpinPage(bm, h));
+    }
+
+  CHECK(shutdownBufferPool(bm));
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// write and read back pages through a pool that bypasses the OS page cache
+void
+testDirectIO (void)
+{
+  int i;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PoolOptions options = { .directIO = true };
+  char *expected = malloc(sizeof(char) * 512);
+  testName = "Testing direct I/O buffer pool";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 3, RS_FIFO, NULL, &options));
+
+  for (i = 0; i < 20; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      ASSERT_TRUE(((size_t) h->data % SM_IO_ALIGNMENT) == 0, "frame is aligned for direct I/O");
+      sprintf(h->data, "%s-%i", "Page", h->pageNum);
+      CHECK(markDirty(bm, h));
+      CHECK(unpinPage(bm, h));
+    }
+  CHECK(shutdownBufferPool(bm));
+
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 3, RS_FIFO, NULL, &options));
+  for (i = 0; i < 20; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      sprintf(expected, "%s-%i", "Page", h->pageNum);
+      ASSERT_EQUALS_STRING(expected, h->data, "reading back page written with direct I/O");
+      CHECK(unpinPage(bm, h));
+    }
+  CHECK(shutdownBufferPool(bm));
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(expected);
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// pin pages in a scattered order through a larger pool, so pages keep entering and leaving its page table
+void
+testPageTable (void)
+{
+  int i, readIO;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PageHandle *pinned = MAKE_PAGE_HANDLE();
+  char *expected = malloc(sizeof(char) * 512);
+  testName = "Testing page lookup in a larger pool";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  createDummyPages(bm, 200);
+  CHECK(initBufferPool(bm, "testbuffer.bin", 64, RS_LRU, NULL));
+
+  // keep one page pinned the whole time, it must never be replaced
+  CHECK(pinPage(bm, pinned, 7));
+  for (i = 0; i < 1000; i++)
+    {
+      CHECK(pinPage(bm, h, (i * 37) % 200));
+      sprintf(expected, "%s-%i", "Page", h->pageNum);
+      ASSERT_EQUALS_STRING(expected, h->data, "reading back page content");
+      CHECK(unpinPage(bm, h));
+    }
+  ASSERT_EQUALS_STRING("Page-7", pinned->data, "pinned page stays in its frame");
+  CHECK(unpinPage(bm, pinned));
+
+  // a working set smaller than the pool is read only once
+  readIO = getNumReadIO(bm);
+  for (i = 0; i < 1000; i++)
+    {
+      CHECK(pinPage(bm, h, (i * 7) % 50));
+      sprintf(expected, "%s-%i", "Page", h->pageNum);
+      ASSERT_EQUALS_STRING(expected, h->data, "reading back page content");
+      CHECK(unpinPage(bm, h));
+    }
+  ASSERT_TRUE((getNumReadIO(bm) - readIO <= 50), "pages still in the pool are found without reading them");
+
+  CHECK(shutdownBufferPool(bm));
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(expected);
+  free(bm);
+  free(h);
+  free(pinned);
+  TEST_DONE();
+}
+
+// use two pools on two page files at the same time, each keeps its own frames and statistics
+void
+testMultiplePools (void)
+{
+  int i;
+  BM_BufferPool *bm1 = MAKE_POOL();
+  BM_BufferPool *bm2 = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  char *expected = malloc(sizeof(char) * 512);
+  testName = "Testing two buffer pools at once";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  createDummyPages(bm1, 10);
+  CHECK(createPageFile("testbuffer2.bin"));
+
+  CHECK(initBufferPool(bm1, "testbuffer.bin", 3, RS_FIFO, NULL));
+  CHECK(initBufferPool(bm2, "testbuffer2.bin", 5, RS_LRU, NULL));
+
+  for (i = 0; i < 5; i++)
+    {
+      CHECK(pinPage(bm2, h, i));
+      sprintf(h->data, "%s-%i", "Other", h->pageNum);
+      CHECK(markDirty(bm2, h));
+      CHECK(unpinPage(bm2, h));
+
+      CHECK(pinPage(bm1, h, i));
+      sprintf(expected, "%s-%i", "Page", h->pageNum);
+      ASSERT_EQUALS_STRING(expected, h->data, "reading back page of the first pool");
+      CHECK(unpinPage(bm1, h));
+    }
+  ASSERT_EQUALS_POOL("[3 0],[4 0],[2 0]", bm1, "first pool content");
+  ASSERT_EQUALS_POOL("[0x0],[1x0],[2x0],[3x0],[4x0]", bm2, "second pool content");
+  ASSERT_EQUALS_INT(5, getNumReadIO(bm1), "check number of read I/Os of the first pool");
+  ASSERT_EQUALS_INT(0, getNumWriteIO(bm1), "check number of write I/Os of the first pool");
+
+  CHECK(shutdownBufferPool(bm2));
+  CHECK(pinPage(bm1, h, 4));
+  ASSERT_EQUALS_STRING("Page-4", h->data, "first pool still works after the second is shut down");
+  CHECK(unpinPage(bm1, h));
+  CHECK(shutdownBufferPool(bm1));
+
+  CHECK(initBufferPool(bm2, "testbuffer2.bin", 5, RS_LRU, NULL));
+  CHECK(pinPage(bm2, h, 3));
+  ASSERT_EQUALS_STRING("Other-3", h->data, "second pool wrote back its own pages");
+  CHECK(unpinPage(bm2, h));
+  CHECK(shutdownBufferPool(bm2));
+
+  CHECK(destroyPageFile("testbuffer.bin"));
+  CHECK(destroyPageFile("testbuffer2.bin"));
+
+  free(expected);
+  free(bm1);
+  free(bm2);
+  free(h);
+  TEST_DONE();
+}
+
+#define NUM_PIN_THREADS 4
+#define PINS_PER_THREAD 2000
+#define COUNTER_OFFSET 64
+
+// pin random pages from one thread and increment a counter on each of them
+static void *
+pinRandomPages (void *arg)
+{
+  BM_BufferPool *bm = ((void **) arg)[0];
+  unsigned int seed = *(unsigned int *) ((void **) arg)[1];
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  int i, counter;
+
+  for (i = 0; i < PINS_PER_THREAD; i++)
+    {
+      seed = seed * 1103515245 + 12345;
+      CHECK(pinPage(bm, h, (seed >> 16) % 32));
+      CHECK(latchPage(bm, h, true));
+      memcpy(&counter, h->data + COUNTER_OFFSET, sizeof(int));
+      counter++;
+      memcpy(h->data + COUNTER_OFFSET, &counter, sizeof(int));
+      CHECK(unlatchPage(bm, h));
+      CHECK(markDirty(bm, h));
+      CHECK(unpinPage(bm, h));
+    }
+
+  free(h);
+  return NULL;
+}
+
+// pin pages from several threads at once with every strategy, no increment may get lost
+void
+testConcurrentPins (void)
+{
+  int i, t, counter, total;
+  ReplacementStrategy strategies[] = { RS_FIFO, RS_LRU, RS_CLOCK, RS_LRU_K, RS_LFU, RS_ARC, RS_2Q };
+  pthread_t threads[NUM_PIN_THREADS];
+  unsigned int seeds[NUM_PIN_THREADS];
+  void *args[NUM_PIN_THREADS][2];
+  BM_PoolStats stats;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  testName = "Testing pins from several threads";
+
+  for (i = 0; i < (int) (sizeof(strategies) / sizeof(strategies[0])); i++)
+    {
+      CHECK(createPageFile("testbuffer.bin"));
+      createDummyPages(bm, 32);
+      CHECK(initBufferPool(bm, "testbuffer.bin", 8, strategies[i], NULL));
+
+      for (t = 0; t < NUM_PIN_THREADS; t++)
+        {
+          seeds[t] = t + 1;
+          args[t][0] = bm;
+          args[t][1] = &seeds[t];
+          ASSERT_TRUE(pthread_create(&threads[t], NULL, pinRandomPages, args[t]) == 0, "start pinning thread");
+        }
+      for (t = 0; t < NUM_PIN_THREADS; t++)
+        pthread_join(threads[t], NULL);
+      CHECK(getPoolStats(bm, &stats));
+      ASSERT_EQUALS_INT(NUM_PIN_THREADS * PINS_PER_THREAD, (int) (stats.hits + stats.misses), "every pin is a hit or a miss");
+      ASSERT_EQUALS_INT(0, stats.numPinned, "no frame pinned after the threads are done");
+      CHECK(shutdownBufferPool(bm));
+
+      // read the counters back from disk, so lost write-backs are caught as well
+      total = 0;
+      CHECK(initBufferPool(bm, "testbuffer.bin", 8, strategies[i], NULL));
+      for (t = 0; t < 32; t++)
+        {
+          CHECK(pinPage(bm, h, t));
+          memcpy(&counter, h->data + COUNTER_OFFSET, sizeof(int));
+          total += counter;
+          CHECK(unpinPage(bm, h));
+        }
+      ASSERT_EQUALS_INT(NUM_PIN_THREADS * PINS_PER_THREAD, total, "every increment reached the page file");
+      CHECK(shutdownBufferPool(bm));
+      CHECK(destroyPageFile("testbuffer.bin"));
+    }
+
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// count the dirty frames of a pool, frames the background writer is still writing count as dirty
+static int
+countDirtyFrames (BM_BufferPool *bm)
+{
+  int i, numDirty = 0;
+  bool *dirty = getDirtyFlags(bm);
+  int *fixCounts = getFixCounts(bm);
+
+  for (i = 0; i < bm->numPages; i++)
+    numDirty += (dirty[i] || fixCounts[i] > 0) ? 1 : 0;
+  free(dirty);
+  free(fixCounts);
+  return numDirty;
+}
+
+// wait up to two seconds until no more than maxDirty frames of a pool are dirty
+static int
+waitForDirtyFrames (BM_BufferPool *bm, int maxDirty)
+{
+  int i, numDirty = countDirtyFrames(bm);
+  struct timespec pause = { 0, 1000000 };
+
+  for (i = 0; i < 2000 && numDirty > maxDirty; i++)
+    {
+      nanosleep(&pause, NULL);
+      numDirty = countDirtyFrames(bm);
+    }
+  return numDirty;
+}
+
+// wait up to two seconds until a pool has read at least minReads pages, prefetched pages are read in the background
+static int
+waitForReadIO (BM_BufferPool *bm, int minReads)
+{
+  int i, numReads = getNumReadIO(bm);
+  struct timespec pause = { 0, 1000000 };
+
+  for (i = 0; i < 2000 && numReads < minReads; i++)
+    {
+      nanosleep(&pause, NULL);
+      numReads = getNumReadIO(bm);
+    }
+  return numReads;
+}
+
+// let the background writer clean pages, so replacing them needs no writes
+void
+testBackgroundWriter (void)
+{
+  int i, writeIO;
+  struct timespec pause = { 0, 50000000 };
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PoolOptions options = { .backgroundWriter = true, .dirtyRatio = 0.5, .writerIntervalMs = 1 };
+  char *expected = malloc(sizeof(char) * 512);
+  testName = "Testing the background writer";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 10, RS_LRU, NULL, &options));
+
+  for (i = 0; i < 10; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      sprintf(h->data, "%s-%i", "Page", h->pageNum);
+      CHECK(markDirty(bm, h));
+      CHECK(unpinPage(bm, h));
+    }
+  ASSERT_TRUE(waitForDirtyFrames(bm, 5) <= 5, "writer brings the pool down to its dirty ratio");
+  CHECK(shutdownBufferPool(bm));
+
+  options.dirtyRatio = 0;
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 10, RS_CLOCK, NULL, &options));
+  for (i = 0; i < 10; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      sprintf(expected, "%s-%i", "Page", h->pageNum);
+      ASSERT_EQUALS_STRING(expected, h->data, "reading back page written by the writer");
+      sprintf(h->data, "%s-%i", "Changed", h->pageNum);
+      CHECK(markDirty(bm, h));
+      CHECK(unpinPage(bm, h));
+    }
+  ASSERT_EQUALS_INT(0, waitForDirtyFrames(bm, 0), "writer cleans every unpinned page");
+
+  // the pages replaced now are clean already
+  writeIO = getNumWriteIO(bm);
+  ASSERT_EQUALS_INT(10, writeIO, "every page is written once");
+  for (i = 10; i < 20; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      CHECK(unpinPage(bm, h));
+    }
+  ASSERT_EQUALS_INT(writeIO, getNumWriteIO(bm), "replacing clean pages writes nothing");
+
+  // a page somebody has pinned may be changing, it is written once it is unpinned
+  CHECK(pinPage(bm, h, 10));
+  CHECK(markDirty(bm, h));
+  nanosleep(&pause, NULL);
+  ASSERT_EQUALS_INT(1, countDirtyFrames(bm), "writer skips pinned pages");
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_INT(0, waitForDirtyFrames(bm, 0), "writer cleans the page once it is unpinned");
+  CHECK(shutdownBufferPool(bm));
+
+  CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_FIFO, NULL));
+  for (i = 0; i < 10; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      sprintf(expected, "%s-%i", "Changed", h->pageNum);
+      ASSERT_EQUALS_STRING(expected, h->data, "reading back page written by the writer");
+      CHECK(unpinPage(bm, h));
+    }
+  CHECK(shutdownBufferPool(bm));
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(expected);
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// a pin from another thread, with its result
+typedef struct WaitingPin
+{
+  BM_BufferPool *bm;
+  PageNumber pageNum;
+  RC rc;
+} WaitingPin;
+
+// pin a page of a full pool from another thread and release it again
+static void *
+pinWhenFree (void *arg)
+{
+  WaitingPin *pin = (WaitingPin *) arg;
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+
+  pin->rc = pinPage(pin->bm, h, pin->pageNum);
+  if (pin->rc == RC_OK)
+    {
+      sprintf(h->data, "%s-%i", "Waited", h->pageNum);
+      CHECK(markDirty(pin->bm, h));
+      CHECK(unpinPage(pin->bm, h));
+    }
+  free(h);
+  return NULL;
+}
+
+// pin pages of a pool whose frames are all pinned, waiting for frames or timing out
+void
+testPinTimeout (void)
+{
+  int i;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h[3];
+  BM_PageHandle *extra = MAKE_PAGE_HANDLE();
+  BM_PoolOptions options = { .pinTimeoutMs = 50 };
+  WaitingPin pins[2];
+  pthread_t threads[2];
+  struct timespec pause = { 0, 20000000 };
+  testName = "Testing pins waiting for a frame";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  createDummyPages(bm, 10);
+
+  // without a timeout a full pool fails at once
+  CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_FIFO, NULL));
+  for (i = 0; i < 3; i++)
+    {
+      h[i] = MAKE_PAGE_HANDLE();
+      CHECK(pinPage(bm, h[i], i));
+    }
+  ASSERT_EQUALS_INT(RC_FULL_BUFFER, pinPage(bm, extra, 3), "full pool without a timeout");
+  for (i = 0; i < 3; i++)
+    CHECK(unpinPage(bm, h[i]));
+  CHECK(shutdownBufferPool(bm));
+
+  // nobody unpins, so the pin times out
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 3, RS_LRU, NULL, &options));
+  for (i = 0; i < 3; i++)
+    CHECK(pinPage(bm, h[i], i));
+  ASSERT_EQUALS_INT(RC_FULL_BUFFER, pinPage(bm, extra, 3), "pin times out when no frame is unpinned");
+  for (i = 0; i < 3; i++)
+    CHECK(unpinPage(bm, h[i]));
+  CHECK(shutdownBufferPool(bm));
+
+  // two waiting threads get a frame each as frames are unpinned
+  for (i = 0; i < 2; i++)
+    {
+      pins[i].bm = bm;
+      pins[i].pageNum = 3 + i;
+      pins[i].rc = RC_OK;
+    }
+  options.pinTimeoutMs = 5000;
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 3, RS_LRU, NULL, &options));
+  for (i = 0; i < 3; i++)
+    CHECK(pinPage(bm, h[i], i));
+  for (i = 0; i < 2; i++)
+    ASSERT_TRUE(pthread_create(&threads[i], NULL, pinWhenFree, &pins[i]) == 0, "start waiting thread");
+  nanosleep(&pause, NULL);
+  CHECK(unpinPage(bm, h[1]));
+  nanosleep(&pause, NULL);
+  CHECK(unpinPage(bm, h[2]));
+  for (i = 0; i < 2; i++)
+    {
+      pthread_join(threads[i], NULL);
+      ASSERT_EQUALS_INT(RC_OK, pins[i].rc, "waiting pin got a frame");
+    }
+  CHECK(unpinPage(bm, h[0]));
+  CHECK(shutdownBufferPool(bm));
+
+  CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_FIFO, NULL));
+  CHECK(pinPage(bm, extra, 4));
+  ASSERT_EQUALS_STRING("Waited-4", extra->data, "page written by a waiting pin");
+  CHECK(unpinPage(bm, extra));
+  CHECK(shutdownBufferPool(bm));
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  for (i = 0; i < 3; i++)
+    free(h[i]);
+  free(extra);
+  free(bm);
+  TEST_DONE();
+}
+
+// scan many pages through a pool with the sequential hint, the pages used before stay in the pool
+void
+testScanRing (void)
+{
+  int i, j, readIO;
+  ReplacementStrategy strategies[] = { RS_FIFO, RS_LRU, RS_CLOCK, RS_LRU_K, RS_LFU, RS_ARC, RS_2Q };
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  char *expected = malloc(sizeof(char) * 512);
+  testName = "Testing sequential scans through the scan ring";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  createDummyPages(bm, 120);
+
+  for (i = 0; i < (int) (sizeof(strategies) / sizeof(strategies[0])); i++)
+    {
+      CHECK(initBufferPool(bm, "testbuffer.bin", 16, strategies[i], NULL));
+      for (j = 0; j < 10; j++)
+        {
+          CHECK(pinPage(bm, h, j));
+          CHECK(unpinPage(bm, h));
+        }
+
+      for (j = 20; j < 120; j++)
+        {
+          CHECK(pinPageWithHint(bm, h, j, BM_HINT_SEQUENTIAL));
+          sprintf(expected, "%s-%i", "Page", h->pageNum);
+          ASSERT_EQUALS_STRING(expected, h->data, "reading back scanned page");
+          CHECK(unpinPage(bm, h));
+        }
+
+      readIO = getNumReadIO(bm);
+      for (j = 0; j < 10; j++)
+        {
+          CHECK(pinPage(bm, h, j));
+          CHECK(unpinPage(bm, h));
+        }
+      ASSERT_EQUALS_INT(readIO, getNumReadIO(bm), "scan did not replace the pages used before");
+      CHECK(shutdownBufferPool(bm));
+    }
+
+  CHECK(destroyPageFile("testbuffer.bin"));
+  free(expected);
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// check whether a page is held in one of the frames of a pool
+static bool
+isInPool (BM_BufferPool *bm, PageNumber pageNum)
+{
+  int i;
+  bool found = false;
+  PageNumber *frameContents = getFrameContents(bm);
+
+  for (i = 0; i < bm->numPages; i++)
+    found = found || frameContents[i] == pageNum;
+  free(frameContents);
+  return found;
+}
+
+// read pages ahead of a sequential run of pins, and prefetch pages without pinning them
+void
+testReadAhead (void)
+{
+  int i, readIO;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  char *expected = malloc(sizeof(char) * 512);
+  testName = "Testing read-ahead and prefetching";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  createDummyPages(bm, 100);
+
+  // the third miss of consecutive pages reads the following pages along with its own
+  CHECK(initBufferPool(bm, "testbuffer.bin", 64, RS_LRU, NULL));
+  for (i = 0; i < 3; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      CHECK(unpinPage(bm, h));
+    }
+  ASSERT_TRUE(isInPool(bm, 3) && isInPool(bm, 10), "pages after a sequential run are read ahead");
+  ASSERT_TRUE(!isInPool(bm, 11), "read-ahead stops after its window");
+  for (i = 3; i < 100; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      sprintf(expected, "%s-%i", "Page", h->pageNum);
+      ASSERT_EQUALS_STRING(expected, h->data, "reading back page read ahead");
+      CHECK(unpinPage(bm, h));
+    }
+  ASSERT_EQUALS_INT(100, getNumReadIO(bm), "every page is read once");
+  CHECK(shutdownBufferPool(bm));
+
+  // prefetched pages are in the pool, unpinned, and stop at the end of the file
+  CHECK(initBufferPool(bm, "testbuffer.bin", 32, RS_CLOCK, NULL));
+  CHECK(prefetchPages(bm, 40, 10));
+  ASSERT_EQUALS_INT(10, waitForReadIO(bm, 10), "prefetch reads every page");
+  CHECK(prefetchPages(bm, 45, 10));
+  ASSERT_EQUALS_INT(15, waitForReadIO(bm, 15), "prefetch skips pages in the pool");
+  CHECK(prefetchPages(bm, 95, 10));
+  ASSERT_EQUALS_INT(20, waitForReadIO(bm, 20), "prefetch stops at the end of the file");
+  readIO = getNumReadIO(bm);
+  for (i = 40; i < 55; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      sprintf(expected, "%s-%i", "Page", h->pageNum);
+      ASSERT_EQUALS_STRING(expected, h->data, "reading back prefetched page");
+      CHECK(unpinPage(bm, h));
+    }
+  ASSERT_EQUALS_INT(readIO, getNumReadIO(bm), "prefetched pages are found in the pool");
+  CHECK(shutdownBufferPool(bm));
+
+  // a pool shut down while its prefetched pages are still being read lets go of the file at once
+  CHECK(initBufferPool(bm, "testbuffer.bin", 32, RS_CLOCK, NULL));
+  CHECK(prefetchPages(bm, 0, 32));
+  CHECK(shutdownBufferPool(bm));
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(expected);
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// a batch pin from another thread, with its result
+typedef struct WaitingBatch
+{
+  BM_BufferPool *bm;
+  PageNumber *pageNums;
+  int numPages;
+  RC rc;
+} WaitingBatch;
+
+// pin a batch of pages of a full pool from another thread and release them again
+static void *
+pinBatchWhenFree (void *arg)
+{
+  WaitingBatch *batch = (WaitingBatch *) arg;
+  BM_PageHandle handles[4];
+
+  batch->rc = pinPages(batch->bm, batch->pageNums, batch->numPages, handles);
+  if (batch->rc == RC_OK)
+    CHECK(unpinPages(batch->bm, handles, batch->numPages));
+  return NULL;
+}
+
+// test pinning and unpinning several pages in one call
+void
+testBatchPins (void)
+{
+  int i, fixed;
+  int *fixCounts;
+  RC rc;
+  PageNumber pages[] = {3, 1, 4, 1, 5, 9, 2, 6};
+  PageNumber tooMany[] = {10, 11, 12, 13, 14, 15, 16};
+  PageNumber waitPages[] = {16, 15};
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PageHandle handles[12];
+  BM_PoolOptions options = { .pinTimeoutMs = 5000 };
+  WaitingBatch batch = { bm, waitPages, 2, RC_OK };
+  pthread_t thread;
+  struct timespec pause = { 0, 20000000 };
+  char *expected = malloc(sizeof(char) * 512);
+  testName = "Testing batch pins";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  createDummyPages(bm, 20);
+
+  // hits and misses are pinned together and a repeated page is pinned twice
+  CHECK(initBufferPool(bm, "testbuffer.bin", 10, RS_LRU, NULL));
+  CHECK(pinPage(bm, h, 4));
+  CHECK(unpinPage(bm, h));
+  CHECK(pinPages(bm, pages, 8, handles));
+  for (i = 0; i < 8; i++)
+    {
+      ASSERT_EQUALS_INT(pages[i], handles[i].pageNum, "handle of the requested page");
+      sprintf(expected, "%s-%i", "Page", pages[i]);
+      ASSERT_EQUALS_STRING(expected, handles[i].data, "reading back a batch pinned page");
+    }
+  ASSERT_EQUALS_INT(7, getNumReadIO(bm), "every missing page is read once");
+  fixCounts = getFixCounts(bm);
+  for (i = 0, fixed = 0; i < 10; i++)
+    fixed += fixCounts[i];
+  free(fixCounts);
+  ASSERT_EQUALS_INT(8, fixed, "one pin per requested page");
+  CHECK(unpinPages(bm, handles, 8));
+  fixCounts = getFixCounts(bm);
+  for (i = 0, fixed = 0; i < 10; i++)
+    fixed += fixCounts[i];
+  free(fixCounts);
+  ASSERT_EQUALS_INT(0, fixed, "batch unpin releases every pin");
+
+  // a batch that does not fit pins nothing
+  CHECK(pinPages(bm, pages, 5, handles));
+  rc = pinPages(bm, tooMany, 7, handles + 5);
+  ASSERT_EQUALS_INT(RC_FULL_BUFFER, rc, "batch larger than the free frames");
+  fixCounts = getFixCounts(bm);
+  for (i = 0, fixed = 0; i < 10; i++)
+    fixed += fixCounts[i];
+  free(fixCounts);
+  ASSERT_EQUALS_INT(5, fixed, "failed batch leaves no pins behind");
+  CHECK(unpinPages(bm, handles, 5));
+  rc = unpinPages(bm, handles, 1);
+  ASSERT_EQUALS_INT(RC_READ_NON_EXISTING_PAGE, rc, "unpinning a page that is not pinned");
+  CHECK(shutdownBufferPool(bm));
+
+  // a batch waits for a frame for every page before it takes any, then writes the dirty pages it replaces together
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 3, RS_LRU, NULL, &options));
+  for (i = 0; i < 3; i++)
+    {
+      CHECK(pinPage(bm, &handles[i], 10 + i));
+      CHECK(markDirty(bm, &handles[i]));
+    }
+  CHECK(unpinPage(bm, &handles[2]));
+  ASSERT_TRUE(pthread_create(&thread, NULL, pinBatchWhenFree, &batch) == 0, "start waiting batch");
+  nanosleep(&pause, NULL);
+  ASSERT_TRUE(isInPool(bm, 12) && !isInPool(bm, 15) && !isInPool(bm, 16), "a waiting batch takes no frame");
+  CHECK(unpinPage(bm, &handles[1]));
+  pthread_join(thread, NULL);
+  ASSERT_EQUALS_INT(RC_OK, batch.rc, "waiting batch got its frames");
+  ASSERT_EQUALS_INT(2, getNumWriteIO(bm), "the dirty pages replaced are written");
+  ASSERT_TRUE(isInPool(bm, 15) && isInPool(bm, 16), "the batch loaded its pages");
+  CHECK(unpinPage(bm, &handles[0]));
+  CHECK(shutdownBufferPool(bm));
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(expected);
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// test the counters of a pool and reading the frames into arrays of the caller
+void
+testPoolStats (void)
+{
+  int i;
+  PageNumber frameContents[3];
+  bool dirty[3];
+  int fixCounts[3];
+  BM_PoolStats stats;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PageHandle *other = MAKE_PAGE_HANDLE();
+  testName = "Testing pool statistics";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  createDummyPages(bm, 10);
+
+  CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_LRU, NULL));
+  CHECK(pinPage(bm, h, 0));
+  CHECK(markDirty(bm, h));
+  CHECK(pinPage(bm, other, 1));
+  CHECK(pinPage(bm, h, 0));
+  CHECK(getPoolStats(bm, &stats));
+  ASSERT_EQUALS_INT(1, (int) stats.hits, "pin of a page in the pool is a hit");
+  ASSERT_EQUALS_INT(2, (int) stats.misses, "pins that read their page are misses");
+  ASSERT_EQUALS_INT(1, stats.numDirty, "one dirty frame");
+  ASSERT_EQUALS_INT(2, stats.numPinned, "a frame pinned twice counts once");
+  CHECK(unpinPage(bm, h));
+  CHECK(unpinPage(bm, h));
+  CHECK(unpinPage(bm, other));
+  CHECK(getPoolStats(bm, &stats));
+  ASSERT_EQUALS_INT(0, stats.numPinned, "no frame pinned after the last unpin");
+
+  // replacing pages counts evictions, and writing the dirty one clears its flag
+  for (i = 2; i < 5; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      CHECK(unpinPage(bm, h));
+    }
+  CHECK(getPoolStats(bm, &stats));
+  ASSERT_EQUALS_INT(2, (int) stats.evictions, "pages replaced for the new ones");
+  ASSERT_EQUALS_INT(1, (int) stats.dirtyEvictions, "the dirty page was written before its replacement");
+  ASSERT_EQUALS_INT(1, (int) stats.cleanEvictions, "the clean page was replaced without a write");
+  ASSERT_EQUALS_INT(0, stats.numDirty, "the replaced dirty page was written");
+  ASSERT_EQUALS_INT(1, getNumWriteIO(bm), "dirty page written at replacement");
+
+  CHECK(getPoolFrames(bm, frameContents, dirty, fixCounts));
+  for (i = 0; i < 3; i++)
+    {
+      ASSERT_TRUE(frameContents[i] >= 2 && frameContents[i] <= 4, "frame holds one of the last pages");
+      ASSERT_TRUE(!dirty[i], "frame is clean");
+      ASSERT_EQUALS_INT(0, fixCounts[i], "frame is not pinned");
+    }
+  CHECK(getPoolFrames(bm, NULL, NULL, fixCounts));
+
+  // flushing the pool clears the dirty count
+  CHECK(pinPage(bm, h, 3));
+  CHECK(markDirty(bm, h));
+  CHECK(markDirty(bm, h));
+  CHECK(unpinPage(bm, h));
+  CHECK(getPoolStats(bm, &stats));
+  ASSERT_EQUALS_INT(1, stats.numDirty, "marking a page dirty twice counts once");
+  CHECK(forceFlushPool(bm));
+  CHECK(getPoolStats(bm, &stats));
+  ASSERT_EQUALS_INT(0, stats.numDirty, "no dirty frame after flushing");
+  ASSERT_EQUALS_INT(2, getNumWriteIO(bm), "flushed page written");
+  CHECK(shutdownBufferPool(bm));
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  free(h);
+  free(other);
+  TEST_DONE();
+}
+
+// test the latency histograms of a pool and the dump of its statistics
+void
+testLatencyStats (void)
+{
+  int i, writeIO;
+  long total;
+  char *dump;
+  BM_PoolStats stats;
+  BM_LatencyHistogram pinMisses, writes, batchWrites;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  testName = "Testing latency statistics";
+
+  for (i = 0; i < BM_LATENCY_BUCKETS - 1; i++)
+    ASSERT_TRUE(getLatencyBucketStart(i) < getLatencyBucketStart(i + 1), "latency buckets grow");
+  ASSERT_EQUALS_INT(10, (int) getLatencyBucketStart(9), "buckets split each power of two in four");
+
+  CHECK(createPageFile("testbuffer.bin"));
+  createDummyPages(bm, 20);
+
+  // every miss, every single write and every batch of writes is recorded once, hits are not
+  CHECK(initBufferPool(bm, "testbuffer.bin", 4, RS_LRU, NULL));
+  for (i = 0; i < 20; i++)
+    {
+      CHECK(pinPage(bm, h, i % 10));
+      if (i % 3 == 0)
+        CHECK(markDirty(bm, h));
+      CHECK(unpinPage(bm, h));
+      CHECK(pinPage(bm, h, i % 10));
+      CHECK(unpinPage(bm, h));
+    }
+  writeIO = getNumWriteIO(bm);
+  CHECK(forceFlushPool(bm));
+  CHECK(getPoolStats(bm, &stats));
+  CHECK(getPoolLatencies(bm, &pinMisses, &writes, &batchWrites));
+  ASSERT_EQUALS_INT((int) stats.misses, (int) pinMisses.count, "one latency per miss");
+  ASSERT_EQUALS_INT(writeIO, (int) writes.count, "one latency per single write");
+  ASSERT_TRUE(getNumWriteIO(bm) > writeIO, "the flush writes the pages left dirty");
+  ASSERT_EQUALS_INT(1, (int) batchWrites.count, "one latency for the whole flush");
+  for (i = 0, total = 0; i < BM_LATENCY_BUCKETS; i++)
+    total += pinMisses.counts[i];
+  ASSERT_EQUALS_INT((int) pinMisses.count, (int) total, "every miss is in a bucket");
+  ASSERT_TRUE(pinMisses.maxNanos > 0 && pinMisses.totalNanos >= pinMisses.maxNanos, "miss latencies are summed");
+  ASSERT_TRUE(getLatencyPercentile(&pinMisses, 50) <= getLatencyPercentile(&pinMisses, 99), "percentiles grow");
+  ASSERT_TRUE(getLatencyPercentile(&pinMisses, 100) == pinMisses.maxNanos, "the last percentile is the largest latency");
+  ASSERT_EQUALS_INT(0, (int) stats.pinWaits, "no pin waited in a single thread");
+
+  dump = sprintPoolStats(bm);
+  ASSERT_TRUE(strstr(dump, "{LRU 4}: hits 20, misses 20") != NULL, "dump starts with the counters");
+  ASSERT_TRUE(strstr(dump, "pinPage misses: count 20") != NULL, "dump shows the miss latencies");
+  ASSERT_TRUE(strstr(dump, "writeBlock: count") != NULL, "dump shows the write latencies");
+  ASSERT_TRUE(strstr(dump, "batched writes: count 1") != NULL, "dump shows the batch latencies");
+  free(dump);
+  printPoolStats(bm);
+  CHECK(shutdownBufferPool(bm));
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// test that a page failing its checksum is reported by every way of pinning it and does not stay in the pool
+void
+testChecksumMismatch (void)
+{
+  int i, fixed;
+  int *fixCounts;
+  FILE *file;
+  RC rc;
+  PageNumber frameContents[3];
+  PageNumber pages[] = {2, 4};
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PageHandle handles[2];
+  testName = "Testing pages failing their checksum";
+
+  CHECK(createPageFileWithFlags("testbuffer.bin", PAGE_SIZE, SM_FILE_CHECKSUMS));
+  createDummyPages(bm, 10);
+
+  // flip one byte of page 4, every page is followed by its 4 byte checksum
+  file = fopen("testbuffer.bin", "r+b");
+  fseek(file, PAGE_SIZE + 4 * (PAGE_SIZE + 4) + 100, SEEK_SET);
+  fputc('x', file);
+  fclose(file);
+
+  CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_LRU, NULL));
+  rc = pinPage(bm, h, 4);
+  ASSERT_EQUALS_INT(RC_CHECKSUM_MISMATCH, rc, "pinPage reports the corrupted page");
+  CHECK(getPoolFrames(bm, frameContents, NULL, NULL));
+  for (i = 0; i < 3; i++)
+    ASSERT_TRUE(frameContents[i] != 4, "the corrupted page is not in the pool");
+  CHECK(pinPage(bm, h, 3));
+  ASSERT_EQUALS_STRING("Page-3", h->data, "other pages are read as before");
+  CHECK(unpinPage(bm, h));
+
+  rc = pinPages(bm, pages, 2, handles);
+  ASSERT_EQUALS_INT(RC_CHECKSUM_MISMATCH, rc, "pinPages reports the corrupted page");
+  CHECK(prefetchPages(bm, 3, 3));
+  rc = pinPage(bm, h, 4);
+  ASSERT_EQUALS_INT(RC_CHECKSUM_MISMATCH, rc, "a prefetched corrupted page is reported when it is pinned");
+  CHECK(pinPage(bm, h, 5));
+  ASSERT_EQUALS_STRING("Page-5", h->data, "the page prefetched along with it is read as before");
+  CHECK(unpinPage(bm, h));
+  fixCounts = getFixCounts(bm);
+  for (i = 0, fixed = 0; i < 3; i++)
+    fixed += fixCounts[i];
+  free(fixCounts);
+  ASSERT_EQUALS_INT(0, fixed, "failed pins leave no pins behind");
+  CHECK(shutdownBufferPool(bm));
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
@@ -8,18 +8,28 @@
 *  The buffer manager supports the management of multiple buffer
 *  pools simultaneously, where each buffer pool is a combination of a
 *  page file and the page frames that store pages from that file.
-*  Two page replacement strategies, namely FIFO and LRU,
+*  Seven page replacement strategies, namely FIFO, LRU, CLOCK, LRU-K, LFU, ARC and 2Q,
 *  have been implemented in this implementation of the buffer manager.
+*  A pool can be used by several threads at once: pins, unpins and the
+*  replacement strategy are synchronized by the pool latch and the locks
+*  of the page table partitions, and threads sharing a page coordinate
+*  their accesses to its data with latchPage.
 *
 *  @author Rushikesh Kadam (A20517258) - rkadam7@hawk.iit.edu
 *  @author Haren Amal (A20513547) - hamal@hawk.iit.edu
 *  @author Gabriel Baranes (A20521263) - gbaranes@hawk.iit.edu
 */
 
+// posix_memalign and strdup are hidden by a strict -std=c99 build
+#define _XOPEN_SOURCE 700
+
 // system-defined libraries
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <errno.h>
 
 // user-defined libraries
 #include "dberror.h"
@@ -27,600 +37,2906 @@
 #include "buffer_mgr.h"
 #include "ds_define.h"
 
-SM_FileHandle *fh;
-BufferQueue *bufferQueue;
-int numOfReadOps;
-int numOfWriteOps;
+// frame descriptors start on a cache line of their own
+#define BM_CACHE_LINE_SIZE 64
+
+// frames a sequential scan cycles through, at most a quarter of the pool
+#define BM_SCAN_RING_FRAMES 16
+
+// pages read ahead of a sequential run of misses, at most an eighth of the pool, so small pools never read ahead
+#define BM_READ_AHEAD_PAGES 8
+
+// misses of consecutive pages in a row, after the first one, that make a sequential run
+#define BM_SEQUENTIAL_RUN 2
 
 /**
 *
-* The BufferQueue structure is used in the implementation of a buffer pool manager that manages the allocation of pages in memory.
-* Here we initialize the BufferQueue.
+* This function allocates size zeroed bytes aligned to alignment, or returns NULL.
 *
 */
-
-void initializeBufferQueue(BM_BufferPool *const bm) //complete refactor haren
+static void *allocateAligned(size_t alignment, size_t size)
 {
-   PageNode *page[bm->numPages];
-   int pageFinal = (bm->numPages);
-   pageFinal--;
-
-
-   int tempPageNumber = pageFinal;
-
-
-
-   while(tempPageNumber >= 0){
-       page[pageFinal - tempPageNumber] = calloc(1, sizeof(PageNode));
-       tempPageNumber--;
-   }
-
-
-   tempPageNumber = 0;
-   while(tempPageNumber <= pageFinal){
-       page[tempPageNumber]->data = (char *)malloc(PAGE_SIZE);
-       page[tempPageNumber]->dirtyFlag = false;
-       page[tempPageNumber]->pageNum = -1;
-       page[tempPageNumber]->fixCount = 0;
-       page[tempPageNumber]->frameNumber = tempPageNumber;
-       tempPageNumber++;
-   }
-
-
-   tempPageNumber = 0;
-   page[tempPageNumber]->prev = NULL;
-   page[tempPageNumber]->next = page[tempPageNumber+1];
-   tempPageNumber++;
-   while(tempPageNumber <= pageFinal){
-       if(tempPageNumber == pageFinal){
-           page[tempPageNumber]->next = NULL;
-           page[tempPageNumber]->prev = page[tempPageNumber-1];
-           tempPageNumber++;  
-           continue;
-       }
-	   int next = tempPageNumber+1;
-	   int prev = tempPageNumber-1;
-       page[tempPageNumber]->next = page[next];
-       page[tempPageNumber]->prev = page[prev];
-       tempPageNumber++;
-      
-   }
-   bufferQueue->numOfFilledFrames = 0;
-   bufferQueue->frameCount = bm->numPages;
-   bufferQueue->front = page[0];
-   bufferQueue->rear = page[pageFinal];
+    void *data = NULL;
+    if (posix_memalign(&data, alignment, size) != 0)
+        return NULL;
+    memset(data, 0, size);
+    return data;
 }
 
-
 /**
 *
-* This function will check whether the BufferQueue is empty
+* This function returns the slot of the page table where the lookup of pageNum starts.
 *
 */
-
-bool isQueueEmpty()
+static int hashPageNum(PageTable *pageTable, int pageNum)
 {
-   return bufferQueue->numOfFilledFrames==0;
+    return (int)(((unsigned int)pageNum * 2654435761u) & (unsigned int)(pageTable->capacity - 1));
 }
 
 /**
 *
-* This function will remove the item from the BufferQueue. Before removing an item it will check whether
-* the queue is empty. If the queue is empty it will simply return the error code. Otherwise it will
-* remove the desired item.
+* This function returns the partition of the page table pageNum belongs to. Each partition has a lock of its own,
+* so looking up pages of different partitions does not contend.
+*
 */
-RC removeBufferItem()
+static PageTable *pagePartition(BufferQueue *bufferQueue, int pageNum)
 {
-	if (isQueueEmpty())
-	{
-		return RC_EMPTY_QUEUE;
-	}
+    return &bufferQueue->pageTable[(unsigned int)pageNum % BM_PAGE_TABLE_PARTITIONS];
+}
 
-	PageNode *page = bufferQueue->front;
+/**
+*
+* This function adds a pin to a frame that is pinned already and returns true, or returns false if the frame is not
+* pinned. A frame only goes from unpinned to pinned under the pool latch, so that the replacement strategy never
+* picks a frame that is being pinned, but further pins only need the lock of the page table partition.
+*
+*/
+static bool pinIfPinned(PageNode *pageNode)
+{
+    int fixCount = __atomic_load_n(&pageNode->fixCount, __ATOMIC_RELAXED);
+    while (fixCount > 0)
+    {
+        if (__atomic_compare_exchange_n(&pageNode->fixCount, &fixCount, fixCount + 1, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+            return true;
+    }
+    return false;
+}
 
-	int tempPageNumber = 0;
-	while(tempPageNumber < bufferQueue->numOfFilledFrames){
-		if(tempPageNumber == bufferQueue->numOfFilledFrames-1){
-        bufferQueue->rear = page;
-		break;
+/**
+*
+* This function removes a pin from a frame that has other pins left and returns true, or returns false if this would
+* be the last pin of the frame. Releasing the last pin needs the pool latch, like taking the first one.
+*
+*/
+static bool unpinIfShared(PageNode *pageNode)
+{
+    int fixCount = __atomic_load_n(&pageNode->fixCount, __ATOMIC_RELAXED);
+    while (fixCount > 1)
+    {
+        if (__atomic_compare_exchange_n(&pageNode->fixCount, &fixCount, fixCount - 1, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+            return true;
     }
-	page = page->next;
-	tempPageNumber++;
-   }
+    return false;
+}
 
-	int rearPage;
-	int deletePageIdx = page->pageNum;
-	page = bufferQueue->rear;
+/**
+*
+* This function tells whether a frame is pinned. The count may change under the caller when it does not hold the
+* lock of the frame's partition, but a frame only becomes unpinned or pinned for the first time under the pool latch.
+*
+*/
+static bool isPinned(PageNode *pageNode)
+{
+    return __atomic_load_n(&pageNode->fixCount, __ATOMIC_RELAXED) > 0;
+}
 
-	tempPageNumber = 0;
-	while(tempPageNumber < bufferQueue->frameCount){
-		if(page->fixCount){
-			rearPage = page->pageNum;
-			page = page->prev;
-		}
-		else if(page->pageNum == bufferQueue->rear->pageNum){
-			bufferQueue->rear = bufferQueue->rear->prev;
-			bufferQueue->rear->next = (bufferQueue->rear->next) == NULL?bufferQueue->rear->next:NULL;
-		}
-		else{
-			page->prev->next = page->next;
-			page->next->prev = page->prev;
-		}
-		tempPageNumber++;
-	}
+/**
+*
+* This function adds a pin to a frame, called with the pool latch held since the frame may be unpinned. The pool
+* keeps count of its pinned frames, so that getPoolStats does not have to look at every frame.
+*
+*/
+static void pinFrame(PoolManagement *pool, PageNode *pageNode)
+{
+    if (__atomic_add_fetch(&pageNode->fixCount, 1, __ATOMIC_ACQ_REL) == 1)
+        __atomic_add_fetch(&pool->numOfPinnedFrames, 1, __ATOMIC_RELAXED);
+}
 
-	if (page->dirtyFlag)
-	{
-		writeBlock(page->pageNum, fh, page->data);
-		numOfWriteOps++;
-	}
-	--bufferQueue->numOfFilledFrames;
-	return rearPage == bufferQueue->rear->pageNum?0:deletePageIdx;
+/**
+*
+* This function sets or clears the dirty flag of a frame and keeps the count of dirty frames of the pool in step.
+*
+*/
+static void setDirtyFlag(PoolManagement *pool, PageNode *pageNode, bool dirty)
+{
+    if (__atomic_exchange_n(&pageNode->dirtyFlag, dirty, __ATOMIC_RELAXED) != dirty)
+        __atomic_add_fetch(&pool->numOfDirtyFrames, dirty ? 1 : -1, __ATOMIC_RELAXED);
 }
 
 /**
 *
-* This function adds a new buffer item to the BufferQueue.
+* This function returns the bucket of a latency histogram a latency falls into. Latencies below
+* BM_LATENCY_SUB_BUCKETS nanoseconds have a bucket each, larger ones are bucketed by their highest bit and the two
+* bits below it, and latencies too large for the last bucket are counted in it.
 *
 */
-RC addBufferItem(BM_PageHandle *const page, const PageNumber pageNum, BM_BufferPool *const bm)
+static int latencyBucket(long nanos)
 {
-	PageNode *pageNode = (PageNode *)malloc(sizeof(PageNode));
-	
-	// Check if the buffer pool is full. If it is, remove a page from the buffer pool to make room for the new page.
-	int deletePageIdx = (bufferQueue->numOfFilledFrames == bufferQueue->frameCount)?removeBufferItem():-1;
+    if (nanos < BM_LATENCY_SUB_BUCKETS)
+        return (nanos > 0) ? (int)nanos : 0;
+    int highestBit = 63 - __builtin_clzl((unsigned long)nanos);
+    int bucket = (highestBit - 1) * BM_LATENCY_SUB_BUCKETS + (int)((nanos >> (highestBit - 2)) & (BM_LATENCY_SUB_BUCKETS - 1));
+    return (bucket < BM_LATENCY_BUCKETS) ? bucket : BM_LATENCY_BUCKETS - 1;
+}
 
-	char *data = (char *)calloc(PAGE_SIZE, sizeof(char));
-	pageNode->prev = NULL;
-	pageNode->next = NULL;
-	pageNode->pageNum = pageNum;
-	pageNode->dirtyFlag = false;
-	pageNode->frameNumber = 0;
-	pageNode->fixCount = 1;
-	pageNode->data = data;
-		
+/**
+*
+* This function returns the nanoseconds that have passed since start, taken from CLOCK_MONOTONIC.
+*
+*/
+static long nanosSince(const struct timespec *start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000000000L + (now.tv_nsec - start->tv_nsec);
+}
 
-	numOfReadOps = readBlock(pageNode->pageNum, fh, pageNode->data) == RC_OK?numOfReadOps+1:numOfReadOps;
-	page->data = pageNode->data;
-	pageNode->next = bufferQueue->front;
-	bufferQueue->front->prev = pageNode;
-	page->pageNum = pageNode->pageNum = pageNum;
-	pageNode->frameNumber = isQueueEmpty()? bufferQueue->front->frameNumber:((deletePageIdx == -1)?(bufferQueue->front->frameNumber + 1):deletePageIdx);
-	bufferQueue->front = pageNode;
-	bufferQueue->numOfFilledFrames++;
-	return RC_OK;
+/**
+*
+* This function adds a latency to a histogram of the pool. Threads record into the same histogram without a lock.
+*
+*/
+static void recordLatency(BM_LatencyHistogram *histogram, long nanos)
+{
+    __atomic_add_fetch(&histogram->counts[latencyBucket(nanos)], 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&histogram->count, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&histogram->totalNanos, nanos, __ATOMIC_RELAXED);
+    long maxNanos = __atomic_load_n(&histogram->maxNanos, __ATOMIC_RELAXED);
+    while (nanos > maxNanos && !__atomic_compare_exchange_n(&histogram->maxNanos, &maxNanos, nanos, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
 }
 
 /**
 *
-* This function updates the attributes of buffer pool.
+* This function counts a pin that had to wait, from start until now, for a frame or for its page to be read.
 *
 */
-void updateBM_BufferPool(BM_BufferPool *const bm, const char *const pageFileName, const int numPages, ReplacementStrategy strategy)
+static void recordPinWait(PoolManagement *pool, const struct timespec *start)
 {
-    bm->pageFile = strdup(pageFileName);
-    bm->numPages = numPages;
-    bm->strategy = strategy;
-	char *buffer = (char *)calloc(numPages, PAGE_SIZE);
-    bm->mgmtData = buffer;
+    __atomic_add_fetch(&pool->numOfPinWaits, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&pool->pinWaitNanos, nanosSince(start), __ATOMIC_RELAXED);
 }
 
 /**
 *
-* This function pins a page in the buffer pool.
+* This function writes the page of a frame to disk with writeBlock, counting the write and its latency.
 *
 */
-RC pinPage(BM_BufferPool *const bm, BM_PageHandle *const page, const PageNumber pageNum)
+static RC writeFrame(PoolManagement *pool, PageNode *pageNode)
 {
-    RC res;
-    switch (bm->strategy)
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    RC rc = writeBlock(pageNode->pageNum, &pool->fh, pageNode->data);
+    if (rc == RC_OK)
     {
-        case RS_FIFO:
-            res = pinPageWithFIFO(bm, page, pageNum);
-            break;
-        case RS_LRU:
-            res = pinPageWithLRU(bm, page, pageNum);
-            break;
-        default:
-            res = RC_INVALID_STRATEGY;
-            break;
+        recordLatency(&pool->writeLatency, nanosSince(&start));
+        __atomic_add_fetch(&pool->numOfWriteOps, 1, __ATOMIC_RELAXED);
     }
-    return res;
+    return rc;
 }
 
 /**
 *
-* This function initializes the Buffer Pool with its attributes like number of pages, page file name, and replacement strategy.
+* This function returns the frame holding pageNum, or NULL if the page is not in the pool. ARC and 2Q look up
+* their ghost entries the same way, in a page table of their own.
 *
 */
-RC initBufferPool(BM_BufferPool *const bm, const char *const pageFileName, const int numPages, ReplacementStrategy strategy, void *stratData)
+static PageNode *findPageNode(PageTable *pageTable, int pageNum)
 {
-    bufferQueue = malloc(sizeof(BufferQueue));
-    fh = malloc(sizeof(SM_FileHandle));
+    int slot = hashPageNum(pageTable, pageNum);
+    while (pageTable->entries[slot].pageNode != NULL)
+    {
+        if (pageTable->entries[slot].pageNum == pageNum)
+            return pageTable->entries[slot].pageNode;
+        slot = (slot + 1) & (pageTable->capacity - 1);
+    }
+    return NULL;
+}
 
-    if (!fh || !bufferQueue) {
-        return RC_BUFFER_POOL_INITIALIZE_ERROR;
+/**
+*
+* This function records in the page table that pageNode holds its page.
+*
+*/
+static void insertPageNode(PageTable *pageTable, PageNode *pageNode)
+{
+    int slot = hashPageNum(pageTable, pageNode->pageNum);
+    while (pageTable->entries[slot].pageNode != NULL)
+    {
+        slot = (slot + 1) & (pageTable->capacity - 1);
     }
-	//If memory gets allocated, call update function for updating the attributes of the buffer pool.
-    updateBM_BufferPool(bm, pageFileName, numPages, strategy);
+    pageTable->entries[slot].pageNum = pageNode->pageNum;
+    pageTable->entries[slot].pageNode = pageNode;
+}
 
-    RC rc = openPageFile(bm->pageFile, fh);
+/**
+*
+* This function removes the page of pageNode from the page table. The entries following it in the same
+* probe run are shifted back into the hole, so lookups never need tombstones.
+*
+*/
+static void removePageNode(PageTable *pageTable, PageNode *pageNode)
+{
+    int mask = pageTable->capacity - 1;
+    int slot = hashPageNum(pageTable, pageNode->pageNum);
+    while (pageTable->entries[slot].pageNode != pageNode)
+    {
+        slot = (slot + 1) & mask;
+    }
 
-    if (rc != RC_OK) {
-        free(fh);
-        free(bufferQueue);
-        return rc;
+    int hole = slot;
+    for (slot = (hole + 1) & mask; pageTable->entries[slot].pageNode != NULL; slot = (slot + 1) & mask)
+    {
+        int home = hashPageNum(pageTable, pageTable->entries[slot].pageNum);
+        if (((slot - home) & mask) >= ((slot - hole) & mask)) //the entry may move back to the hole without passing its home slot
+        {
+            pageTable->entries[hole] = pageTable->entries[slot];
+            hole = slot;
+        }
     }
-    numOfReadOps = numOfWriteOps = 0;
-    initializeBufferQueue(bm);
+    pageTable->entries[hole].pageNode = NULL;
+}
 
-    return RC_OK;
+/**
+*
+* This function allocates an empty page table for up to numEntries pages, with at least twice as many slots.
+*
+*/
+static RC initializePageTable(PageTable *pageTable, int numEntries)
+{
+    pageTable->capacity = 2;
+    while (pageTable->capacity < 2 * numEntries)
+        pageTable->capacity *= 2;
+    pthread_mutex_init(&pageTable->lock, NULL);
+    pageTable->entries = calloc(pageTable->capacity, sizeof(PageTableEntry));
+    return (pageTable->entries != NULL) ? RC_OK : RC_BUFFER_POOL_INITIALIZE_ERROR;
 }
 
+/**
+*
+* This function tells whether frame first is to be replaced before frame second under LRU-K: the frame whose K-th most
+* recent access lies further back goes first. Pages with fewer than K accesses count as infinitely far back, ties are
+* broken by the most recent access and then by frame number.
+*
+*/
+static bool precedesInLRUK(BufferQueue *bufferQueue, PageNode *first, PageNode *second)
+{
+    long firstKth = first->history[bufferQueue->k - 1], secondKth = second->history[bufferQueue->k - 1];
+    if (firstKth != secondKth)
+        return firstKth < secondKth;
+    if (first->history[0] != second->history[0])
+        return first->history[0] < second->history[0];
+    return first->frameNumber < second->frameNumber;
+}
 
 /**
 *
-* This function will shutdown the buffer pool. It writes any dirty pages back to the disk if they are not being used by any process.
+* This function puts a frame at position heapIndex of the LRU-K heap and records the position in the frame.
 *
 */
-RC shutdownBufferPool(BM_BufferPool *const bm)
+static void placeInHeap(BufferQueue *bufferQueue, PageNode *pageNode, int heapIndex)
 {
-    PageNode *currentPageInfo = bufferQueue->front;
-    int numDirtyPagesWritten = 0;
-    while (currentPageInfo != NULL) {
-        if (currentPageInfo->dirtyFlag && currentPageInfo->fixCount == 0) {
-            if (writeBlock(currentPageInfo->pageNum, fh, currentPageInfo->data) != RC_OK)
-                return RC_WRITE_FAILED;
-            numOfWriteOps++;
-            currentPageInfo->dirtyFlag = false;
-        }
-        currentPageInfo = currentPageInfo->next;
-    }
-    closePageFile(fh);
-    return RC_OK;
+    bufferQueue->heap[heapIndex] = pageNode;
+    pageNode->heapIndex = heapIndex;
 }
 
 /**
 *
-* This function forcefully flushes all the dirty pages to the disk.
+* This function restores the heap order around position heapIndex, moving its frame up or down as needed.
 *
 */
-RC forceFlushPool(BM_BufferPool *const bm)
+static void siftHeap(BufferQueue *bufferQueue, int heapIndex)
 {
-    PageNode *currentPageInfo = bufferQueue->front;
-    int idx = 0;
-    
-     while (idx < bufferQueue->frameCount)
+    PageNode *pageNode = bufferQueue->heap[heapIndex];
+    while (heapIndex > 0 && precedesInLRUK(bufferQueue, pageNode, bufferQueue->heap[(heapIndex - 1) / 2]))
     {
-        if (currentPageInfo->dirtyFlag == true)
-        {
-            if (currentPageInfo->fixCount == 0)
-            {
-                writeBlock(currentPageInfo->pageNum, fh, currentPageInfo->data);
-                numOfWriteOps++;
-                currentPageInfo->dirtyFlag = false;
-            }
-        }
-        
-        currentPageInfo = currentPageInfo->next;
-        idx++;
+        placeInHeap(bufferQueue, bufferQueue->heap[(heapIndex - 1) / 2], heapIndex);
+        heapIndex = (heapIndex - 1) / 2;
     }
-    return RC_OK;
+    while (2 * heapIndex + 1 < bufferQueue->heapSize)
+    {
+        int child = 2 * heapIndex + 1;
+        if (child + 1 < bufferQueue->heapSize && precedesInLRUK(bufferQueue, bufferQueue->heap[child + 1], bufferQueue->heap[child]))
+            child++;
+        if (!precedesInLRUK(bufferQueue, bufferQueue->heap[child], pageNode))
+            break;
+        placeInHeap(bufferQueue, bufferQueue->heap[child], heapIndex);
+        heapIndex = child;
+    }
+    placeInHeap(bufferQueue, pageNode, heapIndex);
 }
 
 /**
 *
-* This function unpins the page from the buffer pool
+* This function adds an unpinned frame to the LRU-K heap.
 *
 */
-RC unpinPage(BM_BufferPool *const bm, BM_PageHandle *const page)
+static void pushHeap(BufferQueue *bufferQueue, PageNode *pageNode)
 {
-    PageNode *currentPageInfo = bufferQueue->front;
-    while(currentPageInfo != NULL && currentPageInfo->pageNum != page->pageNum) {
-        currentPageInfo = currentPageInfo->next;
-    }
-    
-    if (!currentPageInfo) {
-        return RC_READ_NON_EXISTING_PAGE;
-    } else {
-        currentPageInfo->fixCount--;
-        return RC_OK;
-    }
+    placeInHeap(bufferQueue, pageNode, bufferQueue->heapSize++);
+    siftHeap(bufferQueue, pageNode->heapIndex);
 }
 
 /**
 *
-* This function will write a page from the buffer pool to disk.
+* This function takes a frame out of the LRU-K heap, when it gets pinned or replaced.
 *
 */
-RC forcePage(BM_BufferPool *const bm, BM_PageHandle *const page) //check again
+static void removeFromHeap(BufferQueue *bufferQueue, PageNode *pageNode)
 {
-	
-    PageNode *currentPageInfo = bufferQueue->front;
-    
-    while (currentPageInfo != NULL && currentPageInfo->pageNum != page->pageNum)
+    int heapIndex = pageNode->heapIndex;
+    PageNode *last = bufferQueue->heap[--bufferQueue->heapSize];
+    pageNode->heapIndex = -1;
+    if (last != pageNode)
     {
-        currentPageInfo = currentPageInfo->next;
+        placeInHeap(bufferQueue, last, heapIndex);
+        siftHeap(bufferQueue, heapIndex);
     }
-    
-    if (!currentPageInfo)
-        return RC_READ_NON_EXISTING_PAGE;
+}
 
-	int writeBlockOut = writeBlock(currentPageInfo->pageNum, fh, currentPageInfo->data);
-	numOfWriteOps = (writeBlockOut)?numOfWriteOps:numOfWriteOps+1;
-	if(writeBlockOut){
-		return RC_WRITE_FAILED;
-	}
-    
+/**
+*
+* This function sets up LRU-K for a pool. params gives K and the correlated reference period, counted in pins of
+* the pool; NULL means K = 2 without a correlated reference period. Every frame keeps the times of its last K
+* uncorrelated accesses, and the unpinned frames are kept in a heap ordered by their K-th most recent access.
+*
+*/
+static RC initializeLRUK(BufferQueue *bufferQueue, BM_LRUKParams *params)
+{
+    bufferQueue->k = (params != NULL && params->k > 0) ? params->k : 2;
+    bufferQueue->correlatedPeriod = (params != NULL && params->correlatedPeriod > 0) ? params->correlatedPeriod : 0;
+    bufferQueue->heap = malloc(bufferQueue->frameCount * sizeof(PageNode *));
+    bufferQueue->skippedFrames = malloc(bufferQueue->frameCount * sizeof(PageNode *));
+    bufferQueue->history = calloc((size_t)bufferQueue->frameCount * bufferQueue->k, sizeof(long));
+    if (bufferQueue->heap == NULL || bufferQueue->skippedFrames == NULL || bufferQueue->history == NULL)
+    {
+        return RC_BUFFER_POOL_INITIALIZE_ERROR;
+    }
+    for (int frameNumber = 0; frameNumber < bufferQueue->frameCount; frameNumber++)
+    {
+        PageNode *pageNode = &bufferQueue->frames[frameNumber];
+        pageNode->history = bufferQueue->history + (size_t)frameNumber * bufferQueue->k;
+        pushHeap(bufferQueue, pageNode);
+    }
     return RC_OK;
 }
 
-
 /**
 *
-* This function marks a page in the buffer pool as dirty.
+* This function records an access to a frame for LRU-K. A newly loaded page starts a fresh history. An access
+* within the correlated reference period of the previous one belongs to the same burst and only moves lastAccess.
+* Any other access shifts the history, carrying the length of the burst that just ended over to the older entries.
 *
 */
-RC markDirty(BM_BufferPool *const bm, BM_PageHandle *const page) {
-    PageNode *currentPageInfo = bufferQueue->front;
-
-    while (currentPageInfo) {
-        if (currentPageInfo->pageNum == page->pageNum) {
-            currentPageInfo->dirtyFlag = true;
-            return RC_OK;
+static void recordAccessLRUK(BufferQueue *bufferQueue, PageNode *pageNode, bool isLoad)
+{
+    long now = ++bufferQueue->accessClock;
+    if (isLoad)
+    {
+        memset(pageNode->history, 0, bufferQueue->k * sizeof(long));
+        pageNode->history[0] = now;
+    }
+    else if (now - pageNode->lastAccess > bufferQueue->correlatedPeriod)
+    {
+        long burstLength = pageNode->lastAccess - pageNode->history[0];
+        for (int i = bufferQueue->k - 1; i > 0; i--)
+        {
+            pageNode->history[i] = pageNode->history[i - 1] ? pageNode->history[i - 1] + burstLength : 0;
         }
-        currentPageInfo = currentPageInfo->next;
+        pageNode->history[0] = now;
     }
-
-    return RC_READ_NON_EXISTING_PAGE;
+    pageNode->lastAccess = now;
 }
 
 /**
 *
-* This function returns an array of page representing the page currently held in each frame of the buffer pool.
+* This function picks the frame for LRU-K: the top of the heap, skipping frames still within the correlated
+* reference period of their last access. If every unpinned frame is, the top of the heap is taken anyway.
 *
 */
-PageNumber *getFrameContents(BM_BufferPool *const bm)
+static PageNode *selectVictimFromHeap(BufferQueue *bufferQueue)
 {
-    PageNumber (*pages)[bm->numPages];
-    pages = calloc(bm->numPages, sizeof(int));  
-    for (int i = 0; i < bm->numPages; i++)
+    if (bufferQueue->heapSize == 0)
+    {
+        return NULL;
+    }
+
+    PageNode **skipped = bufferQueue->skippedFrames;
+    PageNode *pageNode = NULL;
+    int numSkipped = 0;
+    while (bufferQueue->heapSize > 0)
     {
-        PageNode *currentPageInfo = bufferQueue->front;
-        while (currentPageInfo)
+        PageNode *candidate = bufferQueue->heap[0];
+        removeFromHeap(bufferQueue, candidate);
+        if (candidate->pageNum == NO_PAGE || bufferQueue->accessClock - candidate->lastAccess > bufferQueue->correlatedPeriod)
         {
-            if (currentPageInfo->frameNumber == i)
-            {
-                (*pages)[i] = currentPageInfo->pageNum;
-                break;
-            }
-            currentPageInfo = currentPageInfo->next;
+            pageNode = candidate;
+            break;
         }
+        skipped[numSkipped++] = candidate;
     }
-    return *pages;
+    if (pageNode == NULL)
+    {
+        pageNode = skipped[0];
+        for (int i = 1; i < numSkipped; i++)
+            pushHeap(bufferQueue, skipped[i]);
+        return pageNode;
+    }
+    for (int i = 0; i < numSkipped; i++)
+        pushHeap(bufferQueue, skipped[i]);
+    return pageNode;
 }
 
 /**
 *
-* This function returns reference to a boolean array that shows which pages in a buffer pool have been marked as dirty.
+* This function takes a bucket for the given frequency from the spare buckets of the pool and links it into the
+* frequency list right after prevBucket, or at the head of the list if prevBucket is NULL.
 *
 */
-bool *getDirtyFlags(BM_BufferPool *const bm)
+static FrequencyBucket *insertBucket(BufferQueue *bufferQueue, FrequencyBucket *prevBucket, long frequency)
 {
-    bool (*dirtyFlagArray)[bm->numPages];
-    dirtyFlagArray = calloc(bm->numPages, sizeof(bool));
+    FrequencyBucket *bucket = bufferQueue->spareBuckets;
+    bufferQueue->spareBuckets = bucket->next;
+    bucket->frequency = frequency;
+    bucket->first = bucket->last = NULL;
+    bucket->prev = prevBucket;
+    bucket->next = (prevBucket != NULL) ? prevBucket->next : bufferQueue->lowestBucket;
+    if (bucket->next != NULL)
+        bucket->next->prev = bucket;
+    if (prevBucket != NULL)
+        prevBucket->next = bucket;
+    else
+        bufferQueue->lowestBucket = bucket;
+    return bucket;
+}
 
-    for (int i = 0; i < bm->numPages; i++)
-    {
-        PageNode *currentPageInfo = bufferQueue->front;
-        while (currentPageInfo != NULL && currentPageInfo->frameNumber != i) {
-            currentPageInfo = currentPageInfo->next;
-        }
+/**
+*
+* This function unlinks an empty bucket from the frequency list and puts it back among the spare buckets.
+*
+*/
+static void releaseBucket(BufferQueue *bufferQueue, FrequencyBucket *bucket)
+{
+    if (bucket->prev != NULL)
+        bucket->prev->next = bucket->next;
+    else
+        bufferQueue->lowestBucket = bucket->next;
+    if (bucket->next != NULL)
+        bucket->next->prev = bucket->prev;
+    bucket->next = bufferQueue->spareBuckets;
+    bufferQueue->spareBuckets = bucket;
+}
 
-        if (currentPageInfo) {
-            (*dirtyFlagArray)[i] = currentPageInfo->dirtyFlag;
-        }
-    }
-    return *dirtyFlagArray;
+/**
+*
+* This function appends a frame to the list of a bucket. For LFU the next and prev links of a frame chain the frames
+* of its bucket, oldest first, instead of the replacement queue.
+*
+*/
+static void appendToBucket(FrequencyBucket *bucket, PageNode *pageNode)
+{
+    pageNode->bucket = bucket;
+    pageNode->next = NULL;
+    pageNode->prev = bucket->last;
+    if (bucket->last != NULL)
+        bucket->last->next = pageNode;
+    else
+        bucket->first = pageNode;
+    bucket->last = pageNode;
 }
 
 /**
 *
-* This function returns an array of fixCounts for each page in the buffer pool
+* This function takes a frame out of its bucket, releasing the bucket if it became empty.
 *
 */
-int *getFixCounts(BM_BufferPool *const bm) {
-	
-    int (*fixCountsArray)[bm->numPages];
-    fixCountsArray = calloc(bm->numPages, sizeof(int));
+static void removeFromBucket(BufferQueue *bufferQueue, PageNode *pageNode)
+{
+    FrequencyBucket *bucket = pageNode->bucket;
+    if (pageNode->prev != NULL)
+        pageNode->prev->next = pageNode->next;
+    else
+        bucket->first = pageNode->next;
+    if (pageNode->next != NULL)
+        pageNode->next->prev = pageNode->prev;
+    else
+        bucket->last = pageNode->prev;
+    pageNode->bucket = NULL;
+    if (bucket->first == NULL)
+        releaseBucket(bufferQueue, bucket);
+}
 
-    for (int i = 0; i < bm->numPages; i++) {
-		PageNode *currentPageInfo = bufferQueue->front;
-        while (currentPageInfo != NULL && currentPageInfo->frameNumber != i) {
-            currentPageInfo = currentPageInfo->next;
+/**
+*
+* This function moves the frames of bucket into prevBucket and releases bucket. Both lists are ordered by the time
+* their frames entered the bucket, kept in lastAccess, so they are merged by it and the frames stay oldest first.
+*
+*/
+static void mergeBuckets(BufferQueue *bufferQueue, FrequencyBucket *prevBucket, FrequencyBucket *bucket)
+{
+    PageNode *left = prevBucket->first;
+    PageNode *right = bucket->first;
+    prevBucket->first = prevBucket->last = NULL;
+    bucket->first = NULL;
+    while (left != NULL || right != NULL)
+    {
+        PageNode *pageNode;
+        if (right == NULL || (left != NULL && left->lastAccess <= right->lastAccess))
+        {
+            pageNode = left;
+            left = left->next;
         }
-        if (currentPageInfo) {
-            (*fixCountsArray)[i] = currentPageInfo->fixCount;
+        else
+        {
+            pageNode = right;
+            right = right->next;
         }
+        appendToBucket(prevBucket, pageNode);
     }
-    return *fixCountsArray;
+    releaseBucket(bufferQueue, bucket);
 }
 
-
-
 /**
 *
-* This function returns the number of pages that have been read from the disk.
+* This function halves the frequency of every frame. Halving keeps the order of the buckets, so each bucket is
+* renumbered in place and merged into the one before it when both end up with the same frequency. Pages that were
+* hot a long time ago thus lose their advantage over pages that are being used now.
 *
 */
-int getNumReadIO(BM_BufferPool *const bm)
+static void ageFrequencies(BufferQueue *bufferQueue)
 {
-	return numOfReadOps?numOfReadOps:0;
+    FrequencyBucket *bucket = bufferQueue->lowestBucket;
+    while (bucket != NULL)
+    {
+        FrequencyBucket *next = bucket->next;
+        bucket->frequency /= 2;
+        if (bucket->prev != NULL && bucket->prev->frequency == bucket->frequency)
+            mergeBuckets(bufferQueue, bucket->prev, bucket);
+        bucket = next;
+    }
+    bufferQueue->pinsSinceAging = 0;
 }
 
 /**
 *
-* This function returns the number of pages that have been written to the disk.
+* This function sets up LFU for a pool. params gives the number of pins of the pool after which all frequencies are
+* halved; NULL or 0 means eight times the number of frames. Frames are kept in buckets of equal frequency, and the
+* buckets in a list ordered by frequency, so a pin moves a frame to the next bucket in constant time. The empty frames
+* start in a bucket of frequency 0. There is never more than one bucket per frame in use, plus one while a frame
+* moves, so all of them are allocated up front.
 *
 */
-int getNumWriteIO(BM_BufferPool *const bm)
+static RC initializeLFU(BufferQueue *bufferQueue, BM_LFUParams *params)
 {
-	return numOfWriteOps?numOfWriteOps:0;
+    bufferQueue->agingPeriod = (params != NULL && params->agingPeriod > 0) ? params->agingPeriod : 8 * bufferQueue->frameCount;
+    bufferQueue->buckets = calloc(bufferQueue->frameCount + 1, sizeof(FrequencyBucket));
+    if (bufferQueue->buckets == NULL)
+    {
+        return RC_BUFFER_POOL_INITIALIZE_ERROR;
+    }
+    for (int i = 0; i < bufferQueue->frameCount; i++)
+        bufferQueue->buckets[i].next = &bufferQueue->buckets[i + 1];
+    bufferQueue->spareBuckets = &bufferQueue->buckets[0];
+    bufferQueue->lowestBucket = NULL;
+
+    FrequencyBucket *emptyFrames = insertBucket(bufferQueue, NULL, 0);
+    for (int frameNumber = 0; frameNumber < bufferQueue->frameCount; frameNumber++)
+    {
+        bufferQueue->frames[frameNumber].lastAccess = 0;
+        appendToBucket(emptyFrames, &bufferQueue->frames[frameNumber]);
+    }
+    return RC_OK;
 }
 
 /**
 *
-* This function pins a page in the buffer pool using LRU page replacement policy
+* This function records a pin for LFU. A newly loaded page starts with frequency 1, any other pin moves the page to
+* the bucket for one more. lastAccess stamps when the frame entered its bucket. Every agingPeriod pins all
+* frequencies are halved.
 *
 */
-RC pinPageWithLRU(BM_BufferPool *const bm, BM_PageHandle *const page, const PageNumber pageNum)
+static void recordAccessLFU(BufferQueue *bufferQueue, PageNode *pageNode, bool isLoad)
 {
-	bool isPageFound = false;
-	PageNode *pageNode = bufferQueue->front;
-
-	int tempPageNumber = 0;
-	
-	// Loop through all the pages in the buffer pool
-	while(tempPageNumber < bm->numPages){
-
-		// If page is found in the buffer pool, set pageFound flag to 1 and break out of the loop, otherwise goto the next page
-		if(!isPageFound && pageNode->pageNum == pageNum){
-			isPageFound = true;
-			break;
-		}
-		pageNode = pageNode->next;
-		tempPageNumber++;
-	}
-
-	if (!isPageFound)
-	{
-    addBufferItem(page, pageNum, bm);
-	} 
-	else 
-	{
-    pageNode->fixCount++;
-    page->data = pageNode->data;
-    page->pageNum = pageNum;
+    FrequencyBucket *prevBucket;
+    long frequency;
+    if (isLoad)
+    {
+        //the frame was taken out of its bucket when it was picked, frequency 0 is the lowest bucket if any
+        prevBucket = (bufferQueue->lowestBucket != NULL && bufferQueue->lowestBucket->frequency == 0) ? bufferQueue->lowestBucket : NULL;
+        frequency = 1;
+    }
+    else
+    {
+        prevBucket = pageNode->bucket;
+        frequency = prevBucket->frequency + 1;
+    }
 
-    if (pageNode != bufferQueue->front) {
-        if (pageNode == bufferQueue->rear) {
-            bufferQueue->rear = pageNode->prev;
-        }
+    FrequencyBucket *bucket = (prevBucket != NULL) ? prevBucket->next : bufferQueue->lowestBucket;
+    if (bucket == NULL || bucket->frequency != frequency)
+        bucket = insertBucket(bufferQueue, prevBucket, frequency);
+    if (!isLoad)
+        removeFromBucket(bufferQueue, pageNode);
+    pageNode->lastAccess = ++bufferQueue->accessClock;
+    appendToBucket(bucket, pageNode);
 
-        if (pageNode->prev) {
-            pageNode->prev->next = pageNode->next;
-        }
+    if (++bufferQueue->pinsSinceAging >= bufferQueue->agingPeriod)
+        ageFrequencies(bufferQueue);
+}
 
-        if (pageNode->next) {
-            pageNode->next->prev = pageNode->prev;
+/**
+*
+* This function picks the frame for LFU: the oldest unpinned frame of the lowest frequency. The frame is taken out
+* of its bucket.
+*
+*/
+static PageNode *selectVictimFromBuckets(BufferQueue *bufferQueue)
+{
+    for (FrequencyBucket *bucket = bufferQueue->lowestBucket; bucket != NULL; bucket = bucket->next)
+    {
+        for (PageNode *pageNode = bucket->first; pageNode != NULL; pageNode = pageNode->next)
+        {
+            if (!isPinned(pageNode))
+            {
+                removeFromBucket(bufferQueue, pageNode);
+                return pageNode;
+            }
         }
-
-        pageNode->prev = NULL;
-        pageNode->next = bufferQueue->front;
-        bufferQueue->front->prev = pageNode;
-		printf("##Checkpoint##");
-        bufferQueue->front = pageNode;
     }
-}
-	return RC_OK;
+    return NULL;
 }
 
 /**
 *
-* This function pins a page in the buffer pool using FIFO page replacement policy
+* This function appends a frame, or a ghost entry, to the end of an ARC or 2Q list.
 *
 */
-RC pinPageWithFIFO(BM_BufferPool *const bm, BM_PageHandle *const page, const PageNumber pageNum)
+static void appendToList(FrameList *list, PageNode *pageNode)
 {
-	bool isPageFound = false;
-	int numPages = bm->numPages;
-	PageNode *backupPageInfo = NULL;
-	PageNode *currentPageInfo = bufferQueue->front;
-
-	while(currentPageInfo){
-		if(currentPageInfo->pageNum == pageNum){
-			isPageFound = true;
-			break;
-		}
-		currentPageInfo = currentPageInfo->next;
-	}
-
-	if (isPageFound)
-	{
-		++currentPageInfo->fixCount;
-		page->data = currentPageInfo->data;
-		page->pageNum = (page)?pageNum:-1;
-		return RC_OK;
-	}
-
-	currentPageInfo = bufferQueue->front;
-	while (bufferQueue->numOfFilledFrames < bufferQueue->frameCount)
-	{
-		if (currentPageInfo->pageNum == -1)
-		{
-			currentPageInfo->pageNum = pageNum;
-			page->pageNum = pageNum;
-            currentPageInfo->fixCount = 1;
-			currentPageInfo->dirtyFlag = false;
-			bufferQueue->numOfFilledFrames = bufferQueue->numOfFilledFrames + 1;
-			readBlock(currentPageInfo->pageNum, fh, currentPageInfo->data);
-            numOfReadOps = readBlock(currentPageInfo->pageNum, fh, currentPageInfo->data) == RC_OK?numOfReadOps+1:numOfReadOps;
-			page->data = currentPageInfo->data;
-			return RC_OK;
-		}
-		currentPageInfo = currentPageInfo->next;
-	}
-
-
-	PageNode *newNode = (PageNode *)malloc(sizeof(PageNode));
-	newNode->data = NULL;
-	newNode->next = NULL;
-	newNode->fixCount = 1;
-	newNode->dirtyFlag = false;
-	newNode->pageNum = pageNum;
-	page->pageNum = pageNum;
-	newNode->prev = bufferQueue->rear;
-	currentPageInfo = bufferQueue->front;
-	
-	while(currentPageInfo && currentPageInfo->fixCount){
-		currentPageInfo = currentPageInfo->next;
-	}
-
-
-	if (!currentPageInfo)
-	{
-		printf("##Checkpoint: No free buffer##");
-		return RC_FULL_BUFFER;
-	}
-
-	backupPageInfo = currentPageInfo;
-	if (currentPageInfo == bufferQueue->front)
-	{
-		bufferQueue->front->prev = NULL;
-		bufferQueue->front = (bufferQueue)?bufferQueue->front->next:bufferQueue->front;
-	}
-	else if (currentPageInfo != bufferQueue->rear)
-	{
-		currentPageInfo->prev->next = currentPageInfo->next;
-		currentPageInfo->next->prev = currentPageInfo->prev;
-	}
-	else
-	{
-		bufferQueue->rear = currentPageInfo->prev;
-		newNode->prev = (bufferQueue)?bufferQueue->rear:newNode->prev;
-	}
-
-
-	if (backupPageInfo->dirtyFlag == true)
-	{
-		numOfWriteOps = writeBlock(backupPageInfo->pageNum, fh, backupPageInfo->data) == RC_OK?numOfWriteOps+1:numOfWriteOps;
-	}
+    pageNode->list = list;
+    pageNode->next = NULL;
+    pageNode->prev = list->last;
+    if (list->last != NULL)
+        list->last->next = pageNode;
+    else
+        list->first = pageNode;
+    list->last = pageNode;
+    list->size++;
+}
+
+/**
+*
+* This function takes a frame, or a ghost entry, out of the ARC or 2Q list it is in.
+*
+*/
+static void unlinkFromList(PageNode *pageNode)
+{
+    FrameList *list = pageNode->list;
+    if (pageNode->prev != NULL)
+        pageNode->prev->next = pageNode->next;
+    else
+        list->first = pageNode->next;
+    if (pageNode->next != NULL)
+        pageNode->next->prev = pageNode->prev;
+    else
+        list->last = pageNode->prev;
+    pageNode->list = NULL;
+    list->size--;
+}
+
+/**
+*
+* This function returns the unpinned frame closest to the front of a list, or NULL if all of its frames are pinned.
+*
+*/
+static PageNode *firstUnpinned(FrameList *list)
+{
+    PageNode *pageNode = list->first;
+    while (pageNode != NULL && isPinned(pageNode))
+        pageNode = pageNode->next;
+    return pageNode;
+}
+
+/**
+*
+* This function forgets a ghost entry and puts it back among the spare ones.
+*
+*/
+static void dropGhost(BufferQueue *bufferQueue, PageNode *ghost)
+{
+    removePageNode(&bufferQueue->ghostTable, ghost);
+    unlinkFromList(ghost);
+    ghost->next = bufferQueue->spareGhosts;
+    bufferQueue->spareGhosts = ghost;
+}
+
+/**
+*
+* This function remembers the page number of a page that just left the pool, at the end of a ghost list. The ghost
+* lists are kept within their bounds by trimGhosts, but should they ever use up the spare entries, the oldest entry
+* of the longer ghost list makes room.
+*
+*/
+static void addGhost(BufferQueue *bufferQueue, FrameList *ghostList, PageNumber pageNum)
+{
+    if (bufferQueue->spareGhosts == NULL)
+    {
+        FrameList *longer = (bufferQueue->ghostLists[0].size >= bufferQueue->ghostLists[1].size) ? &bufferQueue->ghostLists[0] : &bufferQueue->ghostLists[1];
+        dropGhost(bufferQueue, longer->first);
+    }
+    PageNode *ghost = bufferQueue->spareGhosts;
+    bufferQueue->spareGhosts = ghost->next;
+    ghost->pageNum = pageNum;
+    insertPageNode(&bufferQueue->ghostTable, ghost);
+    appendToList(ghostList, ghost);
+}
+
+/**
+*
+* This function drops the oldest ghost entries beyond the bounds of the strategy, counting the page about to be
+* loaded. ARC keeps the recent side, pages and ghosts, within the number of frames and both sides together within
+* twice that. 2Q keeps at most ghostLimit ghosts.
+*
+*/
+static void trimGhosts(BufferQueue *bufferQueue, ReplacementStrategy strategy)
+{
+    FrameList *recentGhosts = &bufferQueue->ghostLists[0], *frequentGhosts = &bufferQueue->ghostLists[1];
+    if (strategy == RS_2Q)
+    {
+        while (recentGhosts->size > bufferQueue->ghostLimit)
+            dropGhost(bufferQueue, recentGhosts->first);
+        return;
+    }
+
+    int recent = bufferQueue->residentLists[0].size + (bufferQueue->loadList == &bufferQueue->residentLists[0]);
+    int resident = bufferQueue->residentLists[0].size + bufferQueue->residentLists[1].size + 1;
+    while (recentGhosts->size > 0 && recent + recentGhosts->size > bufferQueue->frameCount)
+        dropGhost(bufferQueue, recentGhosts->first);
+    while (resident + recentGhosts->size + frequentGhosts->size > 2 * bufferQueue->frameCount)
+        dropGhost(bufferQueue, frequentGhosts->size > 0 ? frequentGhosts->first : recentGhosts->first);
+}
+
+/**
+*
+* This function sets up ARC or 2Q for a pool. Both keep the pages seen once and the pages seen again in two lists,
+* residentLists[0] and residentLists[1], and the page numbers of pages that recently left the pool in ghost lists,
+* with a page table of their own. Empty frames wait in freeFrames. For 2Q, params gives the share of the frames for
+* pages seen once and the number of ghosts, NULL or 0 meaning a quarter of the frames and half of them. ARC needs no
+* parameters, it moves recentTarget, its share for pages seen once, as ghosts are hit.
+*
+*/
+static RC initializeAdaptive(BufferQueue *bufferQueue, ReplacementStrategy strategy, BM_2QParams *params)
+{
+    int frameCount = bufferQueue->frameCount;
+    if (strategy == RS_2Q)
+    {
+        bufferQueue->recentTarget = (params != NULL && params->recentFrames > 0) ? params->recentFrames : (frameCount + 3) / 4;
+        bufferQueue->ghostLimit = (params != NULL && params->ghostEntries > 0) ? params->ghostEntries : (frameCount + 1) / 2;
+    }
+    else
+    {
+        bufferQueue->recentTarget = 0;
+        bufferQueue->ghostLimit = frameCount + 1;
+    }
+
+    bufferQueue->ghosts = calloc(bufferQueue->ghostLimit, sizeof(PageNode));
+    if (bufferQueue->ghosts == NULL || initializePageTable(&bufferQueue->ghostTable, bufferQueue->ghostLimit) != RC_OK)
+    {
+        return RC_BUFFER_POOL_INITIALIZE_ERROR;
+    }
+    bufferQueue->spareGhosts = NULL;
+    for (int i = bufferQueue->ghostLimit - 1; i >= 0; i--)
+    {
+        bufferQueue->ghosts[i].pageNum = NO_PAGE;
+        bufferQueue->ghosts[i].next = bufferQueue->spareGhosts;
+        bufferQueue->spareGhosts = &bufferQueue->ghosts[i];
+    }
+    for (int frameNumber = 0; frameNumber < frameCount; frameNumber++)
+        appendToList(&bufferQueue->freeFrames, &bufferQueue->frames[frameNumber]);
+    return RC_OK;
+}
+
+/**
+*
+* This function picks the frame for ARC and 2Q and decides which list pageNum goes into once it is loaded.
+* A page whose ghost is found was asked for again soon after it left, so it goes into residentLists[1]. On ARC such
+* a hit also moves recentTarget: towards the recent side for a ghost of residentLists[0], away from it otherwise.
+* Empty frames are used first. Then the front of residentLists[0] is replaced while that list is over its target,
+* otherwise the front of residentLists[1], falling back to the other list if all frames of one are pinned.
+* ARC remembers every replaced page, 2Q only pages replaced from residentLists[0].
+*
+*/
+static PageNode *selectVictimFromLists(BufferQueue *bufferQueue, ReplacementStrategy strategy, PageNumber pageNum)
+{
+    FrameList *recent = &bufferQueue->residentLists[0], *frequent = &bufferQueue->residentLists[1];
+    PageNode *ghost = findPageNode(&bufferQueue->ghostTable, pageNum);
+    bool frequentGhost = (ghost != NULL && ghost->list == &bufferQueue->ghostLists[1]);
+    if (ghost != NULL)
+    {
+        if (strategy == RS_ARC)
+        {
+            int recentGhosts = bufferQueue->ghostLists[0].size, frequentGhosts = bufferQueue->ghostLists[1].size;
+            if (frequentGhost)
+                bufferQueue->recentTarget -= (recentGhosts > frequentGhosts) ? recentGhosts / frequentGhosts : 1;
+            else
+                bufferQueue->recentTarget += (frequentGhosts > recentGhosts) ? frequentGhosts / recentGhosts : 1;
+            bufferQueue->recentTarget = bufferQueue->recentTarget < 0 ? 0 : bufferQueue->recentTarget > bufferQueue->frameCount ? bufferQueue->frameCount : bufferQueue->recentTarget;
+        }
+        dropGhost(bufferQueue, ghost);
+    }
+    bufferQueue->loadList = (ghost != NULL) ? frequent : recent;
+
+    PageNode *pageNode = bufferQueue->freeFrames.first;
+    if (pageNode == NULL)
+    {
+        bool fromRecent = recent->size > bufferQueue->recentTarget || (strategy == RS_ARC && frequentGhost && recent->size > 0 && recent->size == bufferQueue->recentTarget);
+        pageNode = firstUnpinned(fromRecent ? recent : frequent);
+        if (pageNode == NULL)
+            pageNode = firstUnpinned(fromRecent ? frequent : recent);
+        if (pageNode == NULL)
+        {
+            return NULL;
+        }
+        if (pageNode->pageNum != NO_PAGE && (strategy == RS_ARC || pageNode->list == recent)) //a page that failed to load left the frame empty
+            addGhost(bufferQueue, (pageNode->list == recent) ? &bufferQueue->ghostLists[0] : &bufferQueue->ghostLists[1], pageNode->pageNum);
+    }
+    unlinkFromList(pageNode);
+    trimGhosts(bufferQueue, strategy);
+    return pageNode;
+}
+
+/**
+*
+* The BufferQueue structure is used in the implementation of a buffer pool manager that manages the allocation of pages in memory.
+* Here we initialize the BufferQueue of a pool with one frame per page of the pool, all of them empty and linked in
+* frame order, and a page table for them. The data of all frames is one arena aligned to SM_IO_ALIGNMENT, so that a
+* pool opened with direct I/O reads and writes frames without bouncing, and the frame descriptors are one array.
+* Frames are recycled in place, so loading a page never allocates memory, and so is the scratch space the pool needs
+* for I/O and for picking victims, allocated here once. The page table is split into BM_PAGE_TABLE_PARTITIONS
+* partitions, each large enough to hold every frame.
+*
+*/
+static RC initializeBufferQueue(PoolManagement *pool, int frameCount, ReplacementStrategy strategy, void *stratData)
+{
+    BufferQueue *bufferQueue = &pool->bufferQueue;
+    bufferQueue->frameCount = frameCount;
+    bufferQueue->frames = allocateAligned(BM_CACHE_LINE_SIZE, frameCount * sizeof(PageNode));
+    bufferQueue->frameArena = allocateAligned(SM_IO_ALIGNMENT, (size_t)frameCount * pool->fh.pageSize);
+    bufferQueue->frameIO = malloc(frameCount * sizeof(FrameIO));
+    bufferQueue->writerOrder = malloc(frameCount * sizeof(PageNode *));
+    if (bufferQueue->frames == NULL || bufferQueue->frameArena == NULL || bufferQueue->frameIO == NULL || bufferQueue->writerOrder == NULL)
+    {
+        return RC_BUFFER_POOL_INITIALIZE_ERROR;
+    }
+    for (int partition = 0; partition < BM_PAGE_TABLE_PARTITIONS; partition++)
+    {
+        if (initializePageTable(&bufferQueue->pageTable[partition], frameCount) != RC_OK)
+            return RC_BUFFER_POOL_INITIALIZE_ERROR;
+    }
+
+    for (int frameNumber = 0; frameNumber < frameCount; frameNumber++)
+    {
+        PageNode *pageNode = &bufferQueue->frames[frameNumber];
+        pageNode->data = bufferQueue->frameArena + (size_t)frameNumber * pool->fh.pageSize;
+        pageNode->pageNum = NO_PAGE;
+        pageNode->frameNumber = frameNumber;
+        bufferQueue->frameIO[frameNumber].pageNode = pageNode;
+        pthread_rwlock_init(&pageNode->latch, NULL);
+        pageNode->prev = (frameNumber > 0) ? &bufferQueue->frames[frameNumber - 1] : NULL;
+        pageNode->next = (frameNumber < frameCount - 1) ? &bufferQueue->frames[frameNumber + 1] : NULL;
+    }
+    bufferQueue->numOfFilledFrames = 0;
+    bufferQueue->front = &bufferQueue->frames[0];
+    bufferQueue->rear = &bufferQueue->frames[frameCount - 1];
+
+    bufferQueue->scanRingSize = (frameCount / 4 < BM_SCAN_RING_FRAMES) ? frameCount / 4 : BM_SCAN_RING_FRAMES;
+    bufferQueue->scanRingSize = (bufferQueue->scanRingSize > 0) ? bufferQueue->scanRingSize : 1;
+    bufferQueue->scanRing = malloc(bufferQueue->scanRingSize * sizeof(PageNode *));
+    if (bufferQueue->scanRing == NULL)
+    {
+        return RC_BUFFER_POOL_INITIALIZE_ERROR;
+    }
+
+    if (strategy == RS_LRU_K)
+    {
+        return initializeLRUK(bufferQueue, (BM_LRUKParams *)stratData);
+    }
+    if (strategy == RS_LFU)
+    {
+        return initializeLFU(bufferQueue, (BM_LFUParams *)stratData);
+    }
+    if (strategy == RS_ARC || strategy == RS_2Q)
+    {
+        return initializeAdaptive(bufferQueue, strategy, (BM_2QParams *)stratData);
+    }
+    return RC_OK;
+}
+
+/**
+*
+* This function frees the frames and the page table of the BufferQueue.
+*
+*/
+static void freeBufferQueue(BufferQueue *bufferQueue)
+{
+    for (int frameNumber = 0; bufferQueue->frames != NULL && frameNumber < bufferQueue->frameCount; frameNumber++)
+        pthread_rwlock_destroy(&bufferQueue->frames[frameNumber].latch);
+    for (int partition = 0; partition < BM_PAGE_TABLE_PARTITIONS; partition++)
+    {
+        free(bufferQueue->pageTable[partition].entries);
+        pthread_mutex_destroy(&bufferQueue->pageTable[partition].lock);
+    }
+    free(bufferQueue->frameArena);
+    free(bufferQueue->frames);
+    free(bufferQueue->frameIO);
+    free(bufferQueue->writerOrder);
+    free(bufferQueue->skippedFrames);
+    free(bufferQueue->heap);
+    free(bufferQueue->scanRing);
+    free(bufferQueue->history);
+    free(bufferQueue->buckets);
+    free(bufferQueue->ghosts);
+    if (bufferQueue->ghostTable.entries != NULL)
+        pthread_mutex_destroy(&bufferQueue->ghostTable.lock);
+    free(bufferQueue->ghostTable.entries);
+}
+
+/**
+*
+* This function moves a frame to the rear of the replacement queue, where it is the last one to be replaced.
+*
+*/
+static void moveToRear(BufferQueue *bufferQueue, PageNode *pageNode)
+{
+    if (pageNode == bufferQueue->rear)
+    {
+        return;
+    }
+    if (pageNode->prev)
+        pageNode->prev->next = pageNode->next;
+    else
+        bufferQueue->front = pageNode->next;
+    pageNode->next->prev = pageNode->prev;
+
+    pageNode->prev = bufferQueue->rear;
+    pageNode->next = NULL;
+    bufferQueue->rear->next = pageNode;
+    bufferQueue->rear = pageNode;
+}
+
+/**
+*
+* This function moves a frame to the front of the replacement queue, where it is the first one to be replaced.
+*
+*/
+static void moveToFront(BufferQueue *bufferQueue, PageNode *pageNode)
+{
+    if (pageNode == bufferQueue->front)
+    {
+        return;
+    }
+    pageNode->prev->next = pageNode->next;
+    if (pageNode->next)
+        pageNode->next->prev = pageNode->prev;
+    else
+        bufferQueue->rear = pageNode->prev;
+
+    pageNode->next = bufferQueue->front;
+    pageNode->prev = NULL;
+    bufferQueue->front->prev = pageNode;
+    bufferQueue->front = pageNode;
+}
+
+/**
+*
+* This function picks the frame for FIFO and LRU: the first frame from the front of the replacement queue that is
+* not pinned. Empty frames stay at the front, so they are used before any page is replaced.
+*
+*/
+static PageNode *selectVictimFromQueue(BufferQueue *bufferQueue)
+{
+    PageNode *pageNode = bufferQueue->front;
+    while (pageNode != NULL && isPinned(pageNode))
+    {
+        pageNode = pageNode->next;
+    }
+    return pageNode;
+}
+
+/**
+*
+* This function picks the frame for CLOCK. The clock hand sweeps over the frames array, clearing the reference bit
+* of every unpinned frame it passes, and stops at the first unpinned frame whose bit is already clear. After two
+* full sweeps every unpinned frame has been cleared once, so if none was found all frames are pinned.
+*
+*/
+static PageNode *selectVictimWithClock(BufferQueue *bufferQueue)
+{
+    for (int step = 0; step < 2 * bufferQueue->frameCount; step++)
+    {
+        PageNode *pageNode = &bufferQueue->frames[bufferQueue->clockHand];
+        bufferQueue->clockHand = (bufferQueue->clockHand + 1) % bufferQueue->frameCount;
+        if (isPinned(pageNode))
+            continue;
+        if (!__atomic_load_n(&pageNode->referenceBit, __ATOMIC_RELAXED))
+            return pageNode;
+        __atomic_store_n(&pageNode->referenceBit, false, __ATOMIC_RELAXED);
+    }
+    return NULL;
+}
+
+/**
+*
+* This function takes the next frame of the scan ring for a page of a sequential scan, or returns NULL if the ring is
+* not full yet or its next frame cannot be reused: it is pinned, or its page has been pinned by other than a scan
+* since it was loaded. The frame is taken out of the structures of the replacement strategy, as if the strategy had
+* picked it.
+*
+*/
+static PageNode *takeFromScanRing(BufferQueue *bufferQueue, ReplacementStrategy strategy)
+{
+    if (bufferQueue->scanRingCount < bufferQueue->scanRingSize)
+    {
+        return NULL;
+    }
+    PageNode *pageNode = bufferQueue->scanRing[bufferQueue->scanRingNext];
+    if (!__atomic_load_n(&pageNode->scanned, __ATOMIC_RELAXED) || isPinned(pageNode))
+    {
+        return NULL;
+    }
+
+    switch (strategy)
+    {
+        case RS_LRU_K:
+            removeFromHeap(bufferQueue, pageNode);
+            break;
+        case RS_LFU:
+            removeFromBucket(bufferQueue, pageNode);
+            break;
+        case RS_ARC:
+        case RS_2Q:
+            unlinkFromList(pageNode);
+            bufferQueue->loadList = &bufferQueue->residentLists[0]; //no ghost is kept for pages of a scan
+            break;
+        default:
+            break;
+    }
+    return pageNode;
+}
+
+/**
+*
+* This function puts the frame a page of a sequential scan was loaded into in the next slot of the scan ring.
+*
+*/
+static void addToScanRing(BufferQueue *bufferQueue, PageNode *pageNode)
+{
+    __atomic_store_n(&pageNode->scanned, true, __ATOMIC_RELAXED);
+    if (bufferQueue->scanRingCount < bufferQueue->scanRingSize)
+    {
+        bufferQueue->scanRing[bufferQueue->scanRingCount++] = pageNode;
+        return;
+    }
+    bufferQueue->scanRing[bufferQueue->scanRingNext] = pageNode;
+    bufferQueue->scanRingNext = (bufferQueue->scanRingNext + 1) % bufferQueue->scanRingSize;
+}
+
+/**
+*
+* This function picks the frame a new page is loaded into with the replacement strategy of the pool, or returns NULL
+* if every frame is pinned.
+*
+*/
+static PageNode *selectVictim(BufferQueue *bufferQueue, ReplacementStrategy strategy, PageNumber pageNum)
+{
+    PageNode *pageNode;
+    switch (strategy)
+    {
+        case RS_CLOCK:
+            pageNode = selectVictimWithClock(bufferQueue);
+            break;
+        case RS_LRU_K:
+            pageNode = selectVictimFromHeap(bufferQueue);
+            break;
+        case RS_LFU:
+            pageNode = selectVictimFromBuckets(bufferQueue);
+            break;
+        case RS_ARC:
+        case RS_2Q:
+            pageNode = selectVictimFromLists(bufferQueue, strategy, pageNum);
+            break;
+        default:
+            pageNode = selectVictimFromQueue(bufferQueue);
+            break;
+    }
+    return pageNode;
+}
+
+/**
+*
+* This function records that a page was pinned, for the replacement strategy. isLoad tells whether the page was
+* just read into its frame or was already in the pool.
+*
+*/
+static void recordAccess(BufferQueue *bufferQueue, PageNode *pageNode, ReplacementStrategy strategy, bool isLoad)
+{
+    switch (strategy)
+    {
+        case RS_FIFO:
+            if (isLoad)
+                moveToRear(bufferQueue, pageNode);
+            break;
+        case RS_LRU:
+            moveToRear(bufferQueue, pageNode);
+            break;
+        case RS_CLOCK:
+            __atomic_store_n(&pageNode->referenceBit, true, __ATOMIC_RELAXED); //a hit costs nothing more than setting the bit
+            break;
+        case RS_LRU_K:
+            if (!isLoad && pageNode->heapIndex >= 0) //the page was unpinned until now
+                removeFromHeap(bufferQueue, pageNode);
+            recordAccessLRUK(bufferQueue, pageNode, isLoad);
+            break;
+        case RS_LFU:
+            recordAccessLFU(bufferQueue, pageNode, isLoad);
+            break;
+        case RS_ARC:
+        case RS_2Q:
+            if (isLoad)
+                appendToList(bufferQueue->loadList, pageNode);
+            else if (strategy == RS_ARC || pageNode->list == &bufferQueue->residentLists[1]) //2Q leaves pages seen once where they are
+            {
+                unlinkFromList(pageNode);
+                appendToList(&bufferQueue->residentLists[1], pageNode);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+*
+* This function records that the last pin of a page was released, for the replacement strategy.
+*
+*/
+static void recordUnpin(BufferQueue *bufferQueue, PageNode *pageNode, ReplacementStrategy strategy)
+{
+    if (strategy == RS_LRU_K)
+    {
+        pushHeap(bufferQueue, pageNode); //only unpinned frames can be replaced
+    }
+}
+
+/**
+*
+* This function puts a frame picked by selectVictim back with the replacement strategy, called when its dirty page
+* could not be written and stays in the pool. The page is kept as if it had just been loaded, so that the next
+* frame picked is another one.
+*
+*/
+static void keepVictim(BufferQueue *bufferQueue, ReplacementStrategy strategy, PageNode *pageNode)
+{
+    if (strategy == RS_ARC || strategy == RS_2Q)
+    {
+        PageNode *ghost = findPageNode(&bufferQueue->ghostTable, pageNode->pageNum);
+        if (ghost != NULL)
+            dropGhost(bufferQueue, ghost);
+        bufferQueue->loadList = &bufferQueue->residentLists[0];
+    }
+    recordAccess(bufferQueue, pageNode, strategy, true);
+    recordUnpin(bufferQueue, pageNode, strategy);
+}
+
+/**
+*
+* This function picks the frame a new page is loaded into, following the replacement strategy of the pool. With
+* VICTIM_WRITE, a dirty page is written back before its frame is handed out, and the background writer, if the pool
+* has one, is woken up to catch up. The frame is returned in *victim. If every frame is pinned, RC_FULL_BUFFER is
+* returned. If the dirty page cannot be written, it stays in the pool, dirty, and RC_WRITE_FAILED is returned. With
+* VICTIM_KEEP_DIRTY, for pages read ahead, a dirty page stays in the pool and RC_FULL_BUFFER is returned. With
+* VICTIM_DEFER_WRITE, for pinPages, the frame is handed out with its page still dirty, for the caller to write.
+* Pages of a sequential scan reuse the frames of the scan ring once it is full, so a scan replaces at most the
+* pages of a few frames instead of the whole pool.
+*
+*/
+static RC findVictim(PoolManagement *pool, ReplacementStrategy strategy, PageNumber pageNum, BM_AccessHint hint, VictimWrite write, PageNode **victim)
+{
+    BufferQueue *bufferQueue = &pool->bufferQueue;
+    PageNode *pageNode = (hint == BM_HINT_SEQUENTIAL) ? takeFromScanRing(bufferQueue, strategy) : NULL;
+    *victim = NULL;
+    if (pageNode == NULL)
+        pageNode = selectVictim(bufferQueue, strategy, pageNum);
+    if (pageNode == NULL)
+    {
+        return RC_FULL_BUFFER;
+    }
+
+    if (pageNode->pageNum != NO_PAGE)
+    {
+        if (pageNode->dirtyFlag && write != VICTIM_DEFER_WRITE)
+        {
+            if (write == VICTIM_KEEP_DIRTY || writeFrame(pool, pageNode) != RC_OK)
+            {
+                keepVictim(bufferQueue, strategy, pageNode);
+                if (pool->writerRunning)
+                    pthread_cond_signal(&pool->writerWakeup);
+                return (write == VICTIM_KEEP_DIRTY) ? RC_FULL_BUFFER : RC_WRITE_FAILED;
+            }
+            setDirtyFlag(pool, pageNode, false);
+            __atomic_add_fetch(&pool->numOfDirtyEvictions, 1, __ATOMIC_RELAXED);
+            if (pool->writerRunning)
+                pthread_cond_signal(&pool->writerWakeup);
+        }
+        else if (!pageNode->dirtyFlag)
+        {
+            __atomic_add_fetch(&pool->numOfCleanEvictions, 1, __ATOMIC_RELAXED);
+        }
+        PageTable *partition = pagePartition(bufferQueue, pageNode->pageNum);
+        pthread_mutex_lock(&partition->lock);
+        removePageNode(partition, pageNode);
+        pthread_mutex_unlock(&partition->lock);
+        bufferQueue->numOfFilledFrames--;
+    }
+    if (hint == BM_HINT_SEQUENTIAL)
+        addToScanRing(bufferQueue, pageNode);
+    else
+        __atomic_store_n(&pageNode->scanned, false, __ATOMIC_RELAXED);
+    *victim = pageNode;
+    return RC_OK;
+}
+
+/**
+*
+* This function is called with the pool latch held when the last pin of a frame has been released. Threads waiting
+* in waitForFrame are woken up, since the frame can be replaced now.
+*
+*/
+static void frameUnpinned(PoolManagement *pool, PageNode *pageNode, ReplacementStrategy strategy)
+{
+    __atomic_sub_fetch(&pool->numOfPinnedFrames, 1, __ATOMIC_RELAXED);
+    recordUnpin(&pool->bufferQueue, pageNode, strategy);
+    if (pool->firstWaiter != NULL)
+        pthread_cond_broadcast(&pool->frameFreed);
+}
+
+/**
+*
+* This function returns the point in time the given number of milliseconds from now, for pthread_cond_timedwait.
+*
+*/
+static struct timespec deadlineAfter(int milliseconds)
+{
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += milliseconds / 1000;
+    deadline.tv_nsec += (long)(milliseconds % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L)
+    {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    return deadline;
+}
+
+/**
+*
+* This function waits until the page of a frame that was just pinned has been read in by the thread loading it.
+* Returns the result of the load. A page that could not be read has left the pool, the caller still holds its pin
+* on the empty frame and releases it with unpinFrame.
+*
+*/
+static RC waitForLoad(PoolManagement *pool, PageNode *pageNode)
+{
+    if (!__atomic_load_n(&pageNode->ioInProgress, __ATOMIC_ACQUIRE))
+    {
+        return pageNode->loadResult;
+    }
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    pthread_mutex_lock(&pool->latch);
+    while (pageNode->ioInProgress)
+        pthread_cond_wait(&pool->frameLoaded, &pool->latch);
+    RC rc = pageNode->loadResult;
+    pthread_mutex_unlock(&pool->latch);
+    recordPinWait(pool, &start);
+    return rc;
+}
+
+/**
+*
+* This function releases a pin on a frame, called with the pool latch held.
+*
+*/
+static void unpinFrame(BM_BufferPool *const bm, PageNode *pageNode)
+{
+    if (__atomic_sub_fetch(&pageNode->fixCount, 1, __ATOMIC_ACQ_REL) == 0)
+        frameUnpinned((PoolManagement *)bm->mgmtData, pageNode, bm->strategy);
+}
+
+/**
+*
+* This function pins a page if it is in the pool, called with the pool latch held. Returns its frame, or NULL if the
+* page is not in the pool.
+*
+*/
+static PageNode *pinResident(PoolManagement *pool, PageTable *partition, PageNumber pageNum)
+{
+    pthread_mutex_lock(&partition->lock);
+    PageNode *pageNode = findPageNode(partition, pageNum);
+    if (pageNode != NULL)
+        pinFrame(pool, pageNode);
+    pthread_mutex_unlock(&partition->lock);
+    return pageNode;
+}
+
+/**
+*
+* This function queues a thread up behind the threads waiting for frames already, called with the pool latch held.
+*
+*/
+static void joinFrameWaiters(PoolManagement *pool, FrameWaiter *waiter)
+{
+    if (pool->lastWaiter != NULL)
+        pool->lastWaiter->next = waiter;
+    else
+        pool->firstWaiter = waiter;
+    pool->lastWaiter = waiter;
+}
+
+/**
+*
+* This function takes a thread out of the queue of threads waiting for frames, called with the pool latch held. The
+* others are woken up, since the next of them may take a frame now.
+*
+*/
+static void leaveFrameWaiters(PoolManagement *pool, FrameWaiter *waiter)
+{
+    FrameWaiter **link = &pool->firstWaiter;
+    FrameWaiter *previous = NULL;
+    while (*link != waiter)
+    {
+        previous = *link;
+        link = &(*link)->next;
+    }
+    *link = waiter->next;
+    if (pool->lastWaiter == waiter)
+        pool->lastWaiter = previous;
+    pthread_cond_broadcast(&pool->frameFreed);
+}
+
+/**
+*
+* This function finds the frame a page that is not in the pool is loaded into, called with the pool latch held.
+* If every frame is pinned and the pool has a pin timeout, the thread queues up behind the threads waiting already
+* and waits for frames to be unpinned, for at most the timeout. Waiting threads are served in the order they came,
+* only the first of them may take a frame. The latch is released while waiting, so the page may have been loaded by
+* another thread meanwhile: it is then pinned and *resident is set. Returns RC_FULL_BUFFER if no frame was found,
+* or the error of findVictim if the page of the frame it picked could not be written.
+*
+*/
+static RC waitForFrame(BM_BufferPool *const bm, PageNumber pageNum, BM_AccessHint hint, PageNode **frame, bool *resident)
+{
+    PoolManagement *pool = (PoolManagement *)bm->mgmtData;
+    PageTable *partition = pagePartition(&pool->bufferQueue, pageNum);
+    *resident = false;
+    *frame = NULL;
+    RC rc = (pool->firstWaiter == NULL) ? findVictim(pool, bm->strategy, pageNum, hint, VICTIM_WRITE, frame) : RC_FULL_BUFFER;
+    if (rc != RC_FULL_BUFFER || pool->pinTimeout <= 0)
+    {
+        return rc;
+    }
+
+    FrameWaiter waiter = { NULL };
+    struct timespec deadline = deadlineAfter(pool->pinTimeout);
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    joinFrameWaiters(pool, &waiter);
+    for (;;)
+    {
+        if (pool->firstWaiter == &waiter && (rc = findVictim(pool, bm->strategy, pageNum, hint, VICTIM_WRITE, frame)) != RC_FULL_BUFFER)
+            break;
+        if (pthread_cond_timedwait(&pool->frameFreed, &pool->latch, &deadline) == ETIMEDOUT)
+        {
+            rc = RC_FULL_BUFFER;
+            break;
+        }
+        if ((*frame = pinResident(pool, partition, pageNum)) != NULL)
+        {
+            *resident = true;
+            rc = RC_OK;
+            break;
+        }
+    }
+
+    leaveFrameWaiters(pool, &waiter);
+    recordPinWait(pool, &start);
+    return rc;
+}
+
+/**
+*
+* This function is called once the asynchronous read or write of a frame has completed.
+*
+*/
+static void completeFrameIO(int pageNum, RC result, void *context)
+{
+    (void)pageNum;
+    ((FrameIO *)context)->result = result;
+}
+
+/**
+*
+* This function puts pageNum into the page table with the frame picked for it, called with the pool latch held and
+* the frame pinned. The frame is published with ioInProgress set, so other threads find the page but wait in
+* waitForLoad until the caller has read it.
+*
+*/
+static void mapFrame(PoolManagement *pool, PageNode *pageNode, PageNumber pageNum)
+{
+    PageTable *partition = pagePartition(&pool->bufferQueue, pageNum);
+    pageNode->pageNum = pageNum;
+    pageNode->loadResult = RC_OK;
+    setDirtyFlag(pool, pageNode, false);
+    __atomic_store_n(&pageNode->ioInProgress, true, __ATOMIC_RELEASE);
+    pthread_mutex_lock(&partition->lock);
+    insertPageNode(partition, pageNode);
+    pthread_mutex_unlock(&partition->lock);
+    pool->bufferQueue.numOfFilledFrames++;
+}
+
+/**
+*
+* This function makes a frame picked by findVictim hold pageNum, called with the pool latch held. The frame is
+* pinned by the calling thread, recorded as loaded with the replacement strategy and published by mapFrame.
+*
+*/
+static void publishFrame(PoolManagement *pool, PageNode *pageNode, PageNumber pageNum, ReplacementStrategy strategy)
+{
+    pinFrame(pool, pageNode);
+    recordAccess(&pool->bufferQueue, pageNode, strategy, true);
+    mapFrame(pool, pageNode, pageNum);
+}
+
+/**
+*
+* This function records the result of reading the page of a frame in its loadResult. A page behind the end of the
+* file cannot be read and starts out empty, any other failure, an I/O error or a checksum mismatch, is kept.
+*
+*/
+static RC setLoadResult(PoolManagement *pool, PageNode *pageNode, RC result)
+{
+    if (result == RC_OK)
+        __atomic_add_fetch(&pool->numOfReadOps, 1, __ATOMIC_RELAXED);
+    else if (pageNode->pageNum >= getTotalNumPages(&pool->fh))
+    {
+        memset(pageNode->data, 0, pool->fh.pageSize);
+        result = RC_OK;
+    }
+    pageNode->loadResult = result;
+    return result;
+}
+
+/**
+*
+* This function reads the pages of frames published by publishFrame, without the pool latch. A single page is read
+* directly, several are submitted together and reaped as one batch, so that runs of adjacent pages are read with
+* single vectored reads, each with the FrameIO of its frame. The result of every read is kept in the loadResult of
+* its frame, the first error is returned.
+*
+*/
+static RC readFrames(PoolManagement *pool, PageNode **frames, int numFrames)
+{
+    if (numFrames == 1)
+    {
+        return setLoadResult(pool, frames[0], readBlock(frames[0]->pageNum, &pool->fh, frames[0]->data));
+    }
+
+    FrameIO *frameIO = pool->bufferQueue.frameIO;
+    int numSubmitted = 0;
+    RC rc = RC_OK;
+    for (int idx = 0; idx < numFrames; idx++)
+    {
+        FrameIO *read = &frameIO[frames[idx]->frameNumber];
+        read->result = submitRead(frames[idx]->pageNum, &pool->fh, frames[idx]->data, completeFrameIO, read);
+        numSubmitted += (read->result == RC_OK) ? 1 : 0;
+    }
+    reapCompletions(numSubmitted);
+    for (int idx = 0; idx < numFrames; idx++)
+    {
+        RC result = frameIO[frames[idx]->frameNumber].result;
+        if (setLoadResult(pool, frames[idx], result) != RC_OK && rc == RC_OK)
+            rc = result;
+    }
+    return rc;
+}
+
+/**
+*
+* This function takes a frame whose page could not be read out of the page table, called with the pool latch held.
+* The frame stays with the replacement strategy as an empty frame, at the front of the queue for FIFO and LRU, and
+* is replaced once the threads that pinned the page have released it.
+*
+*/
+static void unpublishFrame(PoolManagement *pool, PageNode *pageNode, ReplacementStrategy strategy)
+{
+    PageTable *partition = pagePartition(&pool->bufferQueue, pageNode->pageNum);
+    pthread_mutex_lock(&partition->lock);
+    removePageNode(partition, pageNode);
+    pthread_mutex_unlock(&partition->lock);
+    pageNode->pageNum = NO_PAGE;
+    pool->bufferQueue.numOfFilledFrames--;
+    if (strategy == RS_FIFO || strategy == RS_LRU)
+        moveToFront(&pool->bufferQueue, pageNode);
+}
+
+/**
+*
+* This function completes the loading of frames read by readFrames, called with the pool latch held. Pages that
+* could not be read leave the pool, and threads waiting for the pages are woken up. The first numPinned frames stay
+* pinned for the caller, the others are unpinned.
+*
+*/
+static void finishLoads(BM_BufferPool *const bm, PageNode **frames, int numFrames, int numPinned)
+{
+    PoolManagement *pool = (PoolManagement *)bm->mgmtData;
+    for (int idx = 0; idx < numFrames; idx++)
+    {
+        if (frames[idx]->loadResult != RC_OK)
+            unpublishFrame(pool, frames[idx], bm->strategy);
+        __atomic_store_n(&frames[idx]->ioInProgress, false, __ATOMIC_RELEASE);
+        if (idx >= numPinned)
+            unpinFrame(bm, frames[idx]);
+    }
+    pthread_cond_broadcast(&pool->frameLoaded);
+}
+
+/**
+*
+* This function is called on the I/O worker once the detached read of a frame has completed. The frame is finished
+* like a frame read by readFrames, and its read is no longer counted in numOfDetachedReads.
+*
+*/
+static void completeDetachedRead(int pageNum, RC result, void *context)
+{
+    (void)pageNum;
+    FrameIO *read = (FrameIO *)context;
+    BM_BufferPool *const bm = read->bm;
+    PoolManagement *pool = (PoolManagement *)bm->mgmtData;
+    setLoadResult(pool, read->pageNode, result);
+    pthread_mutex_lock(&pool->latch);
+    finishLoads(bm, &read->pageNode, 1, 0);
+    pool->numOfDetachedReads--;
+    pthread_mutex_unlock(&pool->latch);
+}
+
+/**
+*
+* This function starts reading the pages of frames published by publishFrame in the background, without the pool
+* latch, and returns without waiting for them. The reads are detached, handed to the I/O workers together so that
+* runs of adjacent pages are read with single vectored reads, and completeDetachedRead finishes each frame from the
+* worker. Until then the frames stay marked ioInProgress and threads pinning their pages wait in waitForLoad. The
+* frames are counted in numOfDetachedReads by the caller when it publishes them.
+*
+*/
+static void readFramesDetached(BM_BufferPool *const bm, PageNode **frames, int numFrames)
+{
+    PoolManagement *pool = (PoolManagement *)bm->mgmtData;
+    if (numFrames == 0)
+    {
+        return;
+    }
+    for (int idx = 0; idx < numFrames; idx++)
+    {
+        FrameIO *read = &pool->bufferQueue.frameIO[frames[idx]->frameNumber];
+        read->bm = bm;
+        RC rc = submitDetachedRead(frames[idx]->pageNum, &pool->fh, frames[idx]->data, completeDetachedRead, read);
+        if (rc != RC_OK)
+            completeDetachedRead(frames[idx]->pageNum, rc, read);
+    }
+    dispatchSubmittedIO(); //hands the reads to the workers without waiting or reaping
+}
+
+/**
+*
+* This function publishes frames for the pages from startPage on that are not in the pool, for at most count pages,
+* called with the pool latch held. Only free frames and frames of clean pages are taken, so reading ahead never
+* writes. It stops at the end of the page file, when no such frame is left, or when threads are waiting for frames,
+* which come first. Returns the number of frames published into frames, and the last page that
+* is in the pool now in *lastPage.
+*
+*/
+static int publishRange(BM_BufferPool *const bm, PageNumber startPage, int count, BM_AccessHint hint, PageNode **frames, PageNumber *lastPage)
+{
+    PoolManagement *pool = (PoolManagement *)bm->mgmtData;
+    int totalNumPages = getTotalNumPages(&pool->fh);
+    int numPublished = 0;
+    for (PageNumber pageNum = startPage; pageNum < startPage + count && pageNum < totalNumPages; pageNum++)
+    {
+        PageTable *partition = pagePartition(&pool->bufferQueue, pageNum);
+        pthread_mutex_lock(&partition->lock);
+        bool resident = (findPageNode(partition, pageNum) != NULL);
+        pthread_mutex_unlock(&partition->lock);
+        if (!resident)
+        {
+            PageNode *pageNode;
+            if (pool->firstWaiter != NULL || findVictim(pool, bm->strategy, pageNum, hint, VICTIM_KEEP_DIRTY, &pageNode) != RC_OK)
+                break;
+            publishFrame(pool, pageNode, pageNum, bm->strategy);
+            frames[numPublished++] = pageNode;
+        }
+        *lastPage = pageNum;
+    }
+    return numPublished;
+}
+
+/**
+*
+* This function is called with the pool latch held when pageNum was not in the pool. After a run of misses of
+* consecutive pages, the following pages are published for reading ahead, into frames, and the number of them is
+* returned. Pages of a sequential scan are read ahead no further than their scan ring holds. The pages read ahead
+* count as misses of the run, so the miss right after them continues it.
+*
+*/
+static int startReadAhead(BM_BufferPool *const bm, PageNumber pageNum, BM_AccessHint hint, PageNode **frames)
+{
+    PoolManagement *pool = (PoolManagement *)bm->mgmtData;
+    BufferQueue *bufferQueue = &pool->bufferQueue;
+    pool->sequentialMisses = (pageNum == pool->lastMissPage + 1) ? pool->sequentialMisses + 1 : 0;
+    pool->lastMissPage = pageNum;
+    if (pool->sequentialMisses < BM_SEQUENTIAL_RUN)
+    {
+        return 0;
+    }
+
+    int window = (bufferQueue->frameCount / 8 < BM_READ_AHEAD_PAGES) ? bufferQueue->frameCount / 8 : BM_READ_AHEAD_PAGES;
+    if (hint == BM_HINT_SEQUENTIAL && window > bufferQueue->scanRingSize - 1)
+        window = bufferQueue->scanRingSize - 1;
+    return publishRange(bm, pageNum + 1, window, hint, frames, &pool->lastMissPage);
+}
+
+/**
+*
+* This function pins a page, loading it into the frame picked by findVictim if it is not in the pool yet.
+* A page that is pinned already is pinned again with only the lock of its page table partition, for FIFO and CLOCK
+* whose hits need no bookkeeping. Everything else happens under the pool latch, except reading the page: the frame
+* is published with ioInProgress set before the latch is released, and threads pinning the page meanwhile wait in
+* waitForLoad until it has been read. If every frame is pinned, waitForFrame waits for one as long as the pool allows.
+* hint tells how the page is going to be used, a page pinned other than by a sequential scan leaves the scan ring.
+* A miss that continues a run of misses of consecutive pages reads the following pages ahead in the background, the
+* pin only waits for its own page. If the page cannot be read, it is not pinned and the error of the read is returned.
+*
+*/
+static RC pinPageWithStrategy(BM_BufferPool *const bm, BM_PageHandle *const page, const PageNumber pageNum, ReplacementStrategy strategy, BM_AccessHint hint)
+{
+    PoolManagement *pool = (PoolManagement *)bm->mgmtData;
+    BufferQueue *bufferQueue = &pool->bufferQueue;
+    PageTable *partition = pagePartition(bufferQueue, pageNum);
+
+    pthread_mutex_lock(&partition->lock);
+    PageNode *pageNode = findPageNode(partition, pageNum);
+    bool pinned = (pageNode != NULL && pinIfPinned(pageNode));
+    pthread_mutex_unlock(&partition->lock);
+    if (pinned && hint == BM_HINT_NORMAL)
+        __atomic_store_n(&pageNode->scanned, false, __ATOMIC_RELAXED); //the page is used by more than a scan
+    if (pinned && (strategy == RS_FIFO || strategy == RS_CLOCK))
+    {
+        __atomic_add_fetch(&pool->numOfHits, 1, __ATOMIC_RELAXED);
+        recordAccess(bufferQueue, pageNode, strategy, false);
+        RC rc = waitForLoad(pool, pageNode);
+        if (rc != RC_OK)
+        {
+            pthread_mutex_lock(&pool->latch);
+            unpinFrame(bm, pageNode);
+            pthread_mutex_unlock(&pool->latch);
+            return rc;
+        }
+        page->pageNum = pageNum;
+        page->data = pageNode->data;
+        return RC_OK;
+    }
+
+    struct timespec start;
+    RC rc;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    pthread_mutex_lock(&pool->latch);
+    bool resident = pinned;
+    if (!pinned)
+        resident = ((pageNode = pinResident(pool, partition, pageNum)) != NULL);
+    if (!resident && (rc = waitForFrame(bm, pageNum, hint, &pageNode, &resident)) != RC_OK)
+    {
+        pthread_mutex_unlock(&pool->latch);
+        return rc;
+    }
+    if (resident)
+    {
+        if (hint == BM_HINT_NORMAL)
+            __atomic_store_n(&pageNode->scanned, false, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&pool->numOfHits, 1, __ATOMIC_RELAXED);
+        recordAccess(bufferQueue, pageNode, strategy, false);
+        pthread_mutex_unlock(&pool->latch);
+        rc = waitForLoad(pool, pageNode);
+    }
+    else
+    {
+        PageNode *readAhead[BM_READ_AHEAD_PAGES];
+        __atomic_add_fetch(&pool->numOfMisses, 1, __ATOMIC_RELAXED);
+        publishFrame(pool, pageNode, pageNum, strategy);
+        int numReadAhead = startReadAhead(bm, pageNum, hint, readAhead);
+        pool->numOfDetachedReads += numReadAhead;
+        pthread_mutex_unlock(&pool->latch);
+
+        readFramesDetached(bm, readAhead, numReadAhead);
+        readFrames(pool, &pageNode, 1);
+
+        pthread_mutex_lock(&pool->latch);
+        finishLoads(bm, &pageNode, 1, 1);
+        rc = pageNode->loadResult;
+        pthread_mutex_unlock(&pool->latch);
+        recordLatency(&pool->pinMissLatency, nanosSince(&start));
+    }
+
+    if (rc != RC_OK)
+    {
+        pthread_mutex_lock(&pool->latch);
+        unpinFrame(bm, pageNode);
+        pthread_mutex_unlock(&pool->latch);
+        return rc;
+    }
+    page->pageNum = pageNum;
+    page->data = pageNode->data;
+    return RC_OK;
+}
+
+/**
+*
+* This function updates the attributes of buffer pool. The bookkeeping of the pool lives in its mgmtData, so any
+* number of pools can be open at the same time.
+*
+*/
+void updateBM_BufferPool(BM_BufferPool *const bm, const char *const pageFileName, const int numPages, ReplacementStrategy strategy)
+{
+    bm->pageFile = strdup(pageFileName);
+    bm->numPages = numPages;
+    bm->strategy = strategy;
+    bm->mgmtData = calloc(1, sizeof(PoolManagement));
+    if (bm->mgmtData != NULL)
+    {
+        pthread_mutex_init(&((PoolManagement *)bm->mgmtData)->latch, NULL);
+        pthread_cond_init(&((PoolManagement *)bm->mgmtData)->frameLoaded, NULL);
+        pthread_cond_init(&((PoolManagement *)bm->mgmtData)->writerWakeup, NULL);
+        pthread_cond_init(&((PoolManagement *)bm->mgmtData)->frameFreed, NULL);
+    }
+}
+
+/**
+*
+* This function frees the bookkeeping of a pool that is shut down or failed to initialize.
+*
+*/
+static void freePoolManagement(BM_BufferPool *const bm)
+{
+    PoolManagement *pool = (PoolManagement *)bm->mgmtData;
+    if (pool != NULL)
+    {
+        pthread_mutex_destroy(&pool->latch);
+        pthread_cond_destroy(&pool->frameLoaded);
+        pthread_cond_destroy(&pool->writerWakeup);
+        pthread_cond_destroy(&pool->frameFreed);
+    }
+    free(pool);
+    free(bm->pageFile);
+    bm->mgmtData = NULL;
+    bm->pageFile = NULL;
+}
+
+/**
+*
+* This function lists the frames of the pool in the order the replacement strategy would replace them, as far as
+* that order is known without replacing anything. LRU-K frames are listed in heap order, which starts with the next
+* victim but is only roughly sorted after it. Returns the number of frames listed.
+*
+*/
+static int listInReplacementOrder(BufferQueue *bufferQueue, ReplacementStrategy strategy, PageNode **order)
+{
+    int numListed = 0;
+    switch (strategy)
+    {
+        case RS_CLOCK:
+            for (int step = 0; step < bufferQueue->frameCount; step++)
+                order[numListed++] = &bufferQueue->frames[(bufferQueue->clockHand + step) % bufferQueue->frameCount];
+            break;
+        case RS_LRU_K:
+            for (int heapIndex = 0; heapIndex < bufferQueue->heapSize; heapIndex++)
+                order[numListed++] = bufferQueue->heap[heapIndex];
+            break;
+        case RS_LFU:
+            for (FrequencyBucket *bucket = bufferQueue->lowestBucket; bucket != NULL; bucket = bucket->next)
+            {
+                for (PageNode *pageNode = bucket->first; pageNode != NULL; pageNode = pageNode->next)
+                    order[numListed++] = pageNode;
+            }
+            break;
+        case RS_ARC:
+        case RS_2Q:
+        {
+            bool fromRecent = bufferQueue->residentLists[0].size > bufferQueue->recentTarget;
+            for (int list = 0; list < 2; list++)
+            {
+                FrameList *frameList = &bufferQueue->residentLists[fromRecent ? list : 1 - list];
+                for (PageNode *pageNode = frameList->first; pageNode != NULL; pageNode = pageNode->next)
+                    order[numListed++] = pageNode;
+            }
+            break;
+        }
+        default:
+            for (PageNode *pageNode = bufferQueue->front; pageNode != NULL; pageNode = pageNode->next)
+                order[numListed++] = pageNode;
+            break;
+    }
+    return numListed;
+}
+
+/**
+*
+* This function holds an unpinned dirty frame for writing, called with the pool latch held. The frame is pinned and
+* marked ioInProgress, so it cannot be replaced and threads pinning its page meanwhile wait in waitForLoad until the
+* write is done, instead of changing the page under it.
+*
+*/
+static void holdForWrite(BM_BufferPool *const bm, PageNode *pageNode)
+{
+    PoolManagement *pool = (PoolManagement *)bm->mgmtData;
+    if (bm->strategy == RS_LRU_K)
+        removeFromHeap(&pool->bufferQueue, pageNode);
+    //marked before it is pinned, so a thread pinning it through pinIfPinned sees the mark
+    __atomic_store_n(&pageNode->ioInProgress, true, __ATOMIC_RELEASE);
+    pinFrame(pool, pageNode);
+}
+
+/**
+*
+* This function writes the frames held by holdForWrite, called with the pool latch held. The latch is released while
+* the writes are submitted together and reaped as one batch, so they overlap instead of waiting for each other and
+* runs of adjacent pages go out as single vectored writes. The time the batch took is recorded once, in
+* batchWriteLatency. The frames are released afterwards and the threads waiting for them are woken up. Returns
+* RC_WRITE_FAILED if a page could not be written, it stays dirty.
+*
+*/
+static RC writeHeldFrames(BM_BufferPool *const bm, PageNode **frames, int numFrames)
+{
+    PoolManagement *pool = (PoolManagement *)bm->mgmtData;
+    FrameIO *frameIO = pool->bufferQueue.frameIO;
+    int numSubmitted = 0;
+    RC rc = RC_OK;
+    pthread_mutex_unlock(&pool->latch);
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int idx = 0; idx < numFrames; idx++)
+    {
+        FrameIO *write = &frameIO[frames[idx]->frameNumber];
+        write->result = RC_WRITE_FAILED;
+        if (submitWrite(frames[idx]->pageNum, &pool->fh, frames[idx]->data, completeFrameIO, write) == RC_OK)
+            numSubmitted++;
+    }
+    reapCompletions(numSubmitted);
+    if (numSubmitted > 0)
+        recordLatency(&pool->batchWriteLatency, nanosSince(&start));
+    for (int idx = 0; idx < numFrames; idx++)
+    {
+        if (frameIO[frames[idx]->frameNumber].result != RC_OK)
+        {
+            rc = RC_WRITE_FAILED;
+            continue;
+        }
+        setDirtyFlag(pool, frames[idx], false);
+        __atomic_add_fetch(&pool->numOfWriteOps, 1, __ATOMIC_RELAXED);
+    }
+
+    pthread_mutex_lock(&pool->latch);
+    for (int idx = 0; idx < numFrames; idx++)
+    {
+        __atomic_store_n(&frames[idx]->ioInProgress, false, __ATOMIC_RELEASE);
+        unpinFrame(bm, frames[idx]);
+    }
+    pthread_cond_broadcast(&pool->frameLoaded);
+    return rc;
+}
+
+/**
+*
+* This function runs one round of the background writer, called with the pool latch held. If more frames are dirty
+* than the dirty ratio of the pool allows, the unpinned dirty pages that are replaced first are written until the
+* ratio is met again. Only pages nobody has pinned are written, they are held by holdForWrite while they are written.
+* The latch is released for the writes.
+*
+*/
+static void writeAheadOfReplacement(BM_BufferPool *const bm)
+{
+    PoolManagement *pool = (PoolManagement *)bm->mgmtData;
+    BufferQueue *bufferQueue = &pool->bufferQueue;
+    int numDirty = (int)__atomic_load_n(&pool->numOfDirtyFrames, __ATOMIC_RELAXED);
+    int numToWrite = numDirty - (int)(pool->dirtyRatio * bufferQueue->frameCount);
+    if (numToWrite <= 0)
+    {
+        return;
+    }
+
+    PageNode **order = bufferQueue->writerOrder;
+    PageNode **heldPages = order; //the pages to write are collected at the front of the same array
+    int numListed = listInReplacementOrder(bufferQueue, bm->strategy, order);
+    int numHeld = 0;
+    for (int idx = 0; idx < numListed && numHeld < numToWrite; idx++)
+    {
+        PageNode *pageNode = order[idx];
+        if (pageNode->pageNum == NO_PAGE || isPinned(pageNode) || !__atomic_load_n(&pageNode->dirtyFlag, __ATOMIC_RELAXED))
+            continue;
+        holdForWrite(bm, pageNode);
+        heldPages[numHeld++] = pageNode;
+    }
+    writeHeldFrames(bm, heldPages, numHeld);
+}
+
+/**
+*
+* This function is the background writer of a pool. Every writerInterval milliseconds, or earlier when a dirty page
+* had to be written at replacement, it runs a round of writeAheadOfReplacement, until the pool is shut down.
+*
+*/
+static void *runBackgroundWriter(void *arg)
+{
+    BM_BufferPool *const bm = (BM_BufferPool *)arg;
+    PoolManagement *pool = (PoolManagement *)bm->mgmtData;
+
+    pthread_mutex_lock(&pool->latch);
+    while (!pool->stopWriter)
+    {
+        struct timespec deadline = deadlineAfter(pool->writerInterval);
+        pthread_cond_timedwait(&pool->writerWakeup, &pool->latch, &deadline);
+        if (!pool->stopWriter)
+            writeAheadOfReplacement(bm);
+    }
+    pthread_mutex_unlock(&pool->latch);
+    return NULL;
+}
+
+/**
+*
+* This function starts the background writer of a pool opened with the backgroundWriter option.
+*
+*/
+static RC startBackgroundWriter(BM_BufferPool *const bm, BM_PoolOptions *options)
+{
+    PoolManagement *pool = (PoolManagement *)bm->mgmtData;
+    pool->dirtyRatio = options->dirtyRatio < 0 ? 0 : options->dirtyRatio > 1 ? 1 : options->dirtyRatio;
+    pool->writerInterval = (options->writerIntervalMs > 0) ? options->writerIntervalMs : BM_WRITER_INTERVAL_MS;
+    if (pthread_create(&pool->writer, NULL, runBackgroundWriter, bm) != 0)
+        return RC_BUFFER_POOL_INITIALIZE_ERROR;
+    pool->writerRunning = true;
+    return RC_OK;
+}
+
+/**
+*
+* This function stops the background writer of a pool, if it has one, and waits until it is done.
+*
+*/
+static void stopBackgroundWriter(BM_BufferPool *const bm)
+{
+    PoolManagement *pool = (PoolManagement *)bm->mgmtData;
+    if (!pool->writerRunning)
+    {
+        return;
+    }
+    pthread_mutex_lock(&pool->latch);
+    pool->stopWriter = true;
+    pthread_cond_signal(&pool->writerWakeup);
+    pthread_mutex_unlock(&pool->latch);
+    pthread_join(pool->writer, NULL);
+    pool->writerRunning = false;
+}
+
+/**
+*
+* This function pins a page in the buffer pool.
+*
+*/
+RC pinPage(BM_BufferPool *const bm, BM_PageHandle *const page, const PageNumber pageNum)
+{
+    RC res;
+    switch (bm->strategy)
+    {
+        case RS_FIFO:
+            res = pinPageWithFIFO(bm, page, pageNum);
+            break;
+        case RS_LRU:
+            res = pinPageWithLRU(bm, page, pageNum);
+            break;
+        case RS_CLOCK:
+            res = pinPageWithCLOCK(bm, page, pageNum);
+            break;
+        case RS_LRU_K:
+            res = pinPageWithLRUK(bm, page, pageNum);
+            break;
+        case RS_LFU:
+            res = pinPageWithLFU(bm, page, pageNum);
+            break;
+        case RS_ARC:
+            res = pinPageWithARC(bm, page, pageNum);
+            break;
+        case RS_2Q:
+            res = pinPageWith2Q(bm, page, pageNum);
+            break;
+        default:
+            res = RC_INVALID_STRATEGY;
+            break;
+    }
+    return res;
+}
+
+/**
+*
+* This function pins a page like pinPage, telling the pool how the page is going to be used. Pages pinned with
+* BM_HINT_SEQUENTIAL are loaded into a small ring of frames that the scan keeps reusing, so a large sequential
+* scan does not replace the pages other users of the pool are working with.
+*
+*/
+RC pinPageWithHint(BM_BufferPool *const bm, BM_PageHandle *const page, const PageNumber pageNum, BM_AccessHint hint)
+{
+    if (hint == BM_HINT_NORMAL)
+    {
+        return pinPage(bm, page, pageNum);
+    }
+    if (bm->strategy < RS_FIFO || bm->strategy > RS_2Q)
+    {
+        return RC_INVALID_STRATEGY;
+    }
+    return pinPageWithStrategy(bm, page, pageNum, bm->strategy, hint);
+}
+
+/**
+*
+* This function starts reading up to count pages from startPage on into the pool without pinning them, so that
+* pinning them later finds them in the pool. Pages in the pool already are skipped. The pages are read in the
+* background, as vectored reads where they are adjacent, and the function returns without waiting for them: pinning
+* a page still being read waits for it. Only free frames and frames of clean pages are used, reading stops at the end
+* of the page file and when no such frame is left. A page that cannot be read leaves the pool again.
+*
+*/
+RC prefetchPages(BM_BufferPool *const bm, PageNumber startPage, int count)
+{
+    PoolManagement *pool = (PoolManagement *)bm->mgmtData;
+    if (startPage < 0 || count < 0)
+    {
+        return RC_READ_NON_EXISTING_PAGE;
+    }
+    count = (count < bm->numPages) ? count : bm->numPages;
+    PageNode **frames = malloc((count > 0 ? count : 1) * sizeof(PageNode *));
+    PageNumber lastPage;
+    if (frames == NULL)
+    {
+        return RC_FULL_BUFFER;
+    }
+
+    pthread_mutex_lock(&pool->latch);
+    int numFrames = publishRange(bm, startPage, count, BM_HINT_NORMAL, frames, &lastPage);
+    pool->numOfDetachedReads += numFrames;
+    pthread_mutex_unlock(&pool->latch);
+
+    readFramesDetached(bm, frames, numFrames);
+    free(frames);
+    return RC_OK;
+}
+
+/**
+*
+* This function initializes the Buffer Pool with its attributes like number of pages, page file name, and replacement strategy.
+*
+*/
+RC initBufferPool(BM_BufferPool *const bm, const char *const pageFileName, const int numPages, ReplacementStrategy strategy, void *stratData)
+{
+    return initBufferPoolWithOptions(bm, pageFileName, numPages, strategy, stratData, NULL);
+}
+
+/**
+*
+* This function initializes the Buffer Pool like initBufferPool, with additional pool options. With
+* directIO set the page file is opened with SM_MODE_DIRECT, so pages are cached only once, in the pool.
+* With backgroundWriter set the pool starts a thread that writes unpinned dirty pages ahead of their
+* replacement whenever more than dirtyRatio of the frames are dirty, so that a pin which replaces a
+* page usually only has to read the new one. With pinTimeoutMs set, pinPage waits up to that long for a
+* frame to be unpinned when all of them are pinned, instead of failing with RC_FULL_BUFFER right away.
+*
+*/
+RC initBufferPoolWithOptions(BM_BufferPool *const bm, const char *const pageFileName, const int numPages, ReplacementStrategy strategy, void *stratData, BM_PoolOptions *options)
+{
+    updateBM_BufferPool(bm, pageFileName, numPages, strategy);
+    PoolManagement *pool = (PoolManagement *)bm->mgmtData;
+
+    if (!pool || !bm->pageFile) {
+        freePoolManagement(bm);
+        return RC_BUFFER_POOL_INITIALIZE_ERROR;
+    }
+
+    int openMode = (options != NULL && options->directIO) ? SM_MODE_DIRECT : SM_MODE_DEFAULT;
+    RC rc = openPageFileWithMode(bm->pageFile, &pool->fh, openMode);
+    if (rc == RC_OK) {
+        rc = initializeBufferQueue(pool, numPages, strategy, stratData);
+        if (options != NULL)
+            pool->pinTimeout = options->pinTimeoutMs;
+        if (rc == RC_OK && options != NULL && options->backgroundWriter)
+            rc = startBackgroundWriter(bm, options);
+        if (rc != RC_OK) {
+            freeBufferQueue(&pool->bufferQueue);
+            closePageFile(&pool->fh);
+        }
+    }
+
+    if (rc != RC_OK) {
+        freePoolManagement(bm);
+        return rc;
+    }
+    return RC_OK;
+}
+
+
+/**
+*
+* This function returns the size of the pages held in the frames of the pool, which is the page size
+* the pool's page file was created with.
+*
+*/
+int getPoolPageSize(BM_BufferPool *const bm)
+{
+    return ((PoolManagement *)bm->mgmtData)->fh.pageSize;
+}
+
+/**
+*
+* This function will shutdown the buffer pool. It writes any dirty pages back to the disk if they are not being used by any process.
+* No other thread may use the pool while it is shut down.
+*
+*/
+RC shutdownBufferPool(BM_BufferPool *const bm)
+{
+    PoolManagement *pool = (PoolManagement *)bm->mgmtData;
+    pthread_mutex_lock(&pool->latch);
+    while (pool->numOfDetachedReads > 0) //the workers still read into frames of the pool
+        pthread_cond_wait(&pool->frameLoaded, &pool->latch);
+    pthread_mutex_unlock(&pool->latch);
+    stopBackgroundWriter(bm);
+    if (forceFlushPool(bm) != RC_OK)
+        return RC_WRITE_FAILED;
+    freeBufferQueue(&pool->bufferQueue);
+    closePageFile(&pool->fh);
+    freePoolManagement(bm);
+    return RC_OK;
+}
+
+/**
+*
+* This function orders two page nodes by their page number.
+*
+*/
+static int comparePageNum(const void *first, const void *second)
+{
+    return (*(PageNode *const *)first)->pageNum - (*(PageNode *const *)second)->pageNum;
+}
+
+static int comparePageNumbers(const void *first, const void *second)
+{
+    return *(const PageNumber *)first - *(const PageNumber *)second;
+}
+
+/**
+*
+* This function sorts numPages page numbers and drops the repeated ones. Returns the number of distinct pages.
+*
+*/
+static int sortDistinctPages(PageNumber *pageNums, int numPages)
+{
+    int numDistinct = 0;
+    qsort(pageNums, numPages, sizeof(PageNumber), comparePageNumbers);
+    for (int idx = 0; idx < numPages; idx++)
+    {
+        if (numDistinct == 0 || pageNums[idx] != pageNums[numDistinct - 1])
+            pageNums[numDistinct++] = pageNums[idx];
+    }
+    return numDistinct;
+}
+
+/**
+*
+* This function returns whether the pool has a frame for every page of pageNums that pinPages has to load, called
+* with the pool latch held. Every distinct page that is not in a pinned frame needs an unpinned frame, including the
+* pages in the pool, since their frames must not be taken for the others. scratch holds numPages page numbers.
+*
+*/
+static bool hasFramesFor(PoolManagement *pool, const PageNumber *pageNums, int numPages, PageNumber *scratch)
+{
+    BufferQueue *bufferQueue = &pool->bufferQueue;
+    int numListed = 0;
+    for (int idx = 0; idx < numPages; idx++)
+    {
+        PageTable *partition = pagePartition(bufferQueue, pageNums[idx]);
+        pthread_mutex_lock(&partition->lock);
+        PageNode *pageNode = findPageNode(partition, pageNums[idx]);
+        if (pageNode == NULL || !isPinned(pageNode))
+            scratch[numListed++] = pageNums[idx];
+        pthread_mutex_unlock(&partition->lock);
+    }
+    int numUnpinned = bufferQueue->frameCount - __atomic_load_n(&pool->numOfPinnedFrames, __ATOMIC_RELAXED);
+    return sortDistinctPages(scratch, numListed) <= numUnpinned;
+}
+
+/**
+*
+* This function waits until the pool has a frame for every page pinPages has to load, called with the pool latch
+* held before anything is pinned, so a thread waiting here holds no frame that others wait for. It waits like
+* waitForFrame: only if the pool has a pin timeout, behind the threads waiting already and for at most the timeout.
+* Returns RC_FULL_BUFFER if the frames could not be found.
+*
+*/
+static RC waitForFrames(BM_BufferPool *const bm, const PageNumber *pageNums, int numPages, PageNumber *scratch)
+{
+    PoolManagement *pool = (PoolManagement *)bm->mgmtData;
+    if (pool->firstWaiter == NULL && hasFramesFor(pool, pageNums, numPages, scratch))
+    {
+        return RC_OK;
+    }
+    if (pool->pinTimeout <= 0)
+    {
+        return RC_FULL_BUFFER;
+    }
+
+    FrameWaiter waiter = { NULL };
+    RC rc;
+    struct timespec deadline = deadlineAfter(pool->pinTimeout);
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    joinFrameWaiters(pool, &waiter);
+    for (;;)
+    {
+        if (pool->firstWaiter == &waiter && hasFramesFor(pool, pageNums, numPages, scratch))
+        {
+            rc = RC_OK;
+            break;
+        }
+        if (pthread_cond_timedwait(&pool->frameFreed, &pool->latch, &deadline) == ETIMEDOUT)
+        {
+            rc = RC_FULL_BUFFER;
+            break;
+        }
+    }
+    leaveFrameWaiters(pool, &waiter);
+    recordPinWait(pool, &start);
+    return rc;
+}
+
+/**
+*
+* This function writes the dirty pages of the frames pinPages took with VICTIM_DEFER_WRITE, called with the pool
+* latch held. The latch is kept, so nobody reads the pages from the file before they are written. The pages are
+* written in page order, every run of consecutive pages with one vectored writeBlocks call, and the time they took
+* is recorded once, in batchWriteLatency. Returns RC_WRITE_FAILED if a page could not be written, it stays dirty.
+*
+*/
+static RC writeVictims(PoolManagement *pool, PageNode **victims, int numVictims)
+{
+    PageNode **dirtyPages = malloc(numVictims * sizeof(PageNode *));
+    SM_PageHandle *memPages = malloc(numVictims * sizeof(SM_PageHandle));
+    int numDirty = 0;
+    RC rc = RC_OK;
+    if (dirtyPages == NULL || memPages == NULL)
+    {
+        free(dirtyPages);
+        free(memPages);
+        return RC_WRITE_FAILED;
+    }
+    for (int idx = 0; idx < numVictims; idx++)
+    {
+        if (victims[idx]->pageNum != NO_PAGE && victims[idx]->dirtyFlag)
+            dirtyPages[numDirty++] = victims[idx];
+    }
+
+    qsort(dirtyPages, numDirty, sizeof(PageNode *), comparePageNum);
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int first = 0, last; first < numDirty; first = last)
+    {
+        for (last = first + 1; last < numDirty && dirtyPages[last]->pageNum == dirtyPages[last - 1]->pageNum + 1; last++)
+            ;
+        for (int idx = first; idx < last; idx++)
+            memPages[idx - first] = dirtyPages[idx]->data;
+        if (writeBlocks(dirtyPages[first]->pageNum, last - first, &pool->fh, memPages) != RC_OK)
+        {
+            rc = RC_WRITE_FAILED;
+            continue;
+        }
+        for (int idx = first; idx < last; idx++)
+        {
+            setDirtyFlag(pool, dirtyPages[idx], false);
+            __atomic_add_fetch(&pool->numOfWriteOps, 1, __ATOMIC_RELAXED);
+            __atomic_add_fetch(&pool->numOfDirtyEvictions, 1, __ATOMIC_RELAXED);
+        }
+    }
+    if (numDirty > 0)
+        recordLatency(&pool->batchWriteLatency, nanosSince(&start));
+    if (numDirty > 0 && pool->writerRunning)
+        pthread_cond_signal(&pool->writerWakeup);
+    free(dirtyPages);
+    free(memPages);
+    return rc;
+}
+
+/**
+*
+* This function gives a frame pinPages took back when its page is not loaded after all, called with the pool latch
+* held. A dirty page that could not be written stays in the pool, as if it had just been loaded, otherwise the frame
+* is left empty.
+*
+*/
+static void returnVictim(BM_BufferPool *const bm, PageNode *pageNode)
+{
+    PoolManagement *pool = (PoolManagement *)bm->mgmtData;
+    BufferQueue *bufferQueue = &pool->bufferQueue;
+    if (pageNode->pageNum != NO_PAGE && pageNode->dirtyFlag)
+    {
+        PageTable *partition = pagePartition(bufferQueue, pageNode->pageNum);
+        PageNode *ghost = (bm->strategy == RS_ARC || bm->strategy == RS_2Q) ? findPageNode(&bufferQueue->ghostTable, pageNode->pageNum) : NULL;
+        if (ghost != NULL)
+            dropGhost(bufferQueue, ghost);
+        pthread_mutex_lock(&partition->lock);
+        insertPageNode(partition, pageNode);
+        pthread_mutex_unlock(&partition->lock);
+        bufferQueue->numOfFilledFrames++;
+    }
+    else
+    {
+        pageNode->pageNum = NO_PAGE;
+        if (bm->strategy == RS_FIFO || bm->strategy == RS_LRU)
+            moveToFront(bufferQueue, pageNode);
+    }
+    unpinFrame(bm, pageNode);
+}
+
+/**
+*
+* This function forcefully flushes all the dirty pages to the disk. The dirty pages that are not pinned are held by
+* holdForWrite and written in page order by writeHeldFrames, as one batch. The pool latch is released while they are
+* written, the held pages cannot be pinned or replaced meanwhile.
+*
+*/
+RC forceFlushPool(BM_BufferPool *const bm)
+{
+    PoolManagement *pool = (PoolManagement *)bm->mgmtData;
+    BufferQueue *bufferQueue = &pool->bufferQueue;
+    PageNode **dirtyPages = malloc(bufferQueue->frameCount * sizeof(PageNode *));
+    int numDirty = 0;
+    int idx;
+
+    if (dirtyPages == NULL)
+    {
+        return RC_WRITE_FAILED;
+    }
+    pthread_mutex_lock(&pool->latch);
+    for (idx = 0; idx < bufferQueue->frameCount; idx++)
+    {
+        PageNode *currentPageInfo = &bufferQueue->frames[idx];
+        if (currentPageInfo->dirtyFlag == true && !isPinned(currentPageInfo))
+        {
+            holdForWrite(bm, currentPageInfo);
+            dirtyPages[numDirty++] = currentPageInfo;
+        }
+    }
+
+    qsort(dirtyPages, numDirty, sizeof(PageNode *), comparePageNum);
+    RC rc = writeHeldFrames(bm, dirtyPages, numDirty);
+    pthread_mutex_unlock(&pool->latch);
+    free(dirtyPages);
+    return rc;
+}
+
+/**
+*
+* This function unpins the page from the buffer pool
+*
+*/
+RC unpinPage(BM_BufferPool *const bm, BM_PageHandle *const page)
+{
+    PoolManagement *pool = (PoolManagement *)bm->mgmtData;
+    PageTable *partition = pagePartition(&pool->bufferQueue, page->pageNum);
+    pthread_mutex_lock(&partition->lock);
+    PageNode *currentPageInfo = findPageNode(partition, page->pageNum);
+    bool unpinned = (currentPageInfo != NULL && unpinIfShared(currentPageInfo));
+    pthread_mutex_unlock(&partition->lock);
+    
+    if (!currentPageInfo) {
+        return RC_READ_NON_EXISTING_PAGE;
+    } else if (!unpinned) {
+        //the last pin is released under the pool latch, the page may have been replaced if it was not pinned at all
+        pthread_mutex_lock(&pool->latch);
+        pthread_mutex_lock(&partition->lock);
+        currentPageInfo = findPageNode(partition, page->pageNum);
+        pthread_mutex_unlock(&partition->lock);
+        if (currentPageInfo && isPinned(currentPageInfo) && __atomic_sub_fetch(&currentPageInfo->fixCount, 1, __ATOMIC_ACQ_REL) == 0)
+            frameUnpinned(pool, currentPageInfo, bm->strategy);
+        pthread_mutex_unlock(&pool->latch);
+    }
+    return RC_OK;
+}
+
+/**
+*
+* This function looks up the frame of a page the caller has pinned, under the lock of its page table partition.
+*
+*/
+static PageNode *findPinnedPage(PoolManagement *pool, PageNumber pageNum)
+{
+    PageTable *partition = pagePartition(&pool->bufferQueue, pageNum);
+    pthread_mutex_lock(&partition->lock);
+    PageNode *pageNode = findPageNode(partition, pageNum);
+    pthread_mutex_unlock(&partition->lock);
+    return pageNode;
+}
+
+/**
+*
+* This function latches the data of a pinned page, shared for reading or exclusive for writing. Pinning only keeps
+* a page in the pool, threads that share a page latch it around their accesses to its data. forcePage takes the
+* shared latch itself, so a thread has to release an exclusive latch before forcing the page.
+*
+*/
+RC latchPage(BM_BufferPool *const bm, BM_PageHandle *const page, bool exclusive)
+{
+    PageNode *pageNode = findPinnedPage((PoolManagement *)bm->mgmtData, page->pageNum);
+    if (pageNode == NULL)
+        return RC_READ_NON_EXISTING_PAGE;
+    if (exclusive)
+        pthread_rwlock_wrlock(&pageNode->latch);
+    else
+        pthread_rwlock_rdlock(&pageNode->latch);
+    return RC_OK;
+}
+
+/**
+*
+* This function releases the latch taken on a page with latchPage.
+*
+*/
+RC unlatchPage(BM_BufferPool *const bm, BM_PageHandle *const page)
+{
+    PageNode *pageNode = findPinnedPage((PoolManagement *)bm->mgmtData, page->pageNum);
+    if (pageNode == NULL)
+        return RC_READ_NON_EXISTING_PAGE;
+    pthread_rwlock_unlock(&pageNode->latch);
+    return RC_OK;
+}
+
+/**
+*
+* This function unpins several pages at once, taking the pool latch only once for all of them. Every page is
+* unpinned even if some of them are not in the pool, which is reported with RC_READ_NON_EXISTING_PAGE.
+*
+*/
+RC unpinPages(BM_BufferPool *const bm, BM_PageHandle *const handles, int numPages)
+{
+    PoolManagement *pool = (PoolManagement *)bm->mgmtData;
+    RC rc = RC_OK;
+    pthread_mutex_lock(&pool->latch);
+    for (int idx = 0; idx < numPages; idx++)
+    {
+        PageNode *pageNode = findPinnedPage(pool, handles[idx].pageNum);
+        if (pageNode == NULL || !isPinned(pageNode))
+            rc = RC_READ_NON_EXISTING_PAGE;
+        else if (__atomic_sub_fetch(&pageNode->fixCount, 1, __ATOMIC_ACQ_REL) == 0)
+            frameUnpinned(pool, pageNode, bm->strategy);
+    }
+    pthread_mutex_unlock(&pool->latch);
+    return rc;
+}
+
+/**
+*
+* This function pins several pages at once into handles, one handle per page. It first waits until the pool has a
+* frame for every page, with waitForFrames, so nothing is pinned or published while it waits. Then, under the pool
+* latch, the pages in the pool are pinned, a frame is taken for every other page, the dirty pages of those frames are
+* written back as one batch by writeVictims, and the missing pages are published. They are read together afterwards,
+* as vectored reads where they are adjacent. A page may appear more than once and is then pinned once per appearance.
+* If a page cannot be pinned or read, the pages pinned so far are unpinned again and the error is returned.
+*
+*/
+RC pinPages(BM_BufferPool *const bm, const PageNumber *pageNums, int numPages, BM_PageHandle *const handles)
+{
+    PoolManagement *pool = (PoolManagement *)bm->mgmtData;
+    int capacity = (numPages > 0) ? numPages : 1;
+    PageNode **frames = malloc(2 * capacity * sizeof(PageNode *)); //sized by the caller, so not on the stack
+    PageNumber *loadPages = malloc(capacity * sizeof(PageNumber));
+    int numLoads = 0, numTaken = 0;
+    int idx;
+    RC rc;
+    if (frames == NULL || loadPages == NULL)
+    {
+        free(frames);
+        free(loadPages);
+        return RC_FULL_BUFFER;
+    }
+    PageNode **loads = frames + capacity;
+
+    pthread_mutex_lock(&pool->latch);
+    rc = waitForFrames(bm, pageNums, numPages, loadPages);
+    if (rc != RC_OK)
+    {
+        pthread_mutex_unlock(&pool->latch);
+        free(frames);
+        free(loadPages);
+        return rc;
+    }
+
+    //the pages in the pool are pinned first, so their frames are not taken for the others
+    for (idx = 0; idx < numPages; idx++)
+    {
+        frames[idx] = pinResident(pool, pagePartition(&pool->bufferQueue, pageNums[idx]), pageNums[idx]);
+        if (frames[idx] == NULL)
+        {
+            loadPages[numLoads++] = pageNums[idx];
+            continue;
+        }
+        __atomic_store_n(&frames[idx]->scanned, false, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&pool->numOfHits, 1, __ATOMIC_RELAXED);
+        recordAccess(&pool->bufferQueue, frames[idx], bm->strategy, false);
+    }
+    numLoads = sortDistinctPages(loadPages, numLoads);
+
+    //every frame is taken before any page is written or published, pinned so that it is not picked twice
+    for (numTaken = 0; numTaken < numLoads; numTaken++)
+    {
+        if ((rc = findVictim(pool, bm->strategy, loadPages[numTaken], BM_HINT_NORMAL, VICTIM_DEFER_WRITE, &loads[numTaken])) != RC_OK)
+            break;
+        pinFrame(pool, loads[numTaken]);
+        recordAccess(&pool->bufferQueue, loads[numTaken], bm->strategy, true);
+    }
+    if (rc == RC_OK)
+        rc = writeVictims(pool, loads, numLoads);
+    if (rc != RC_OK)
+    {
+        for (idx = 0; idx < numTaken; idx++)
+            returnVictim(bm, loads[idx]);
+        for (idx = 0; idx < numPages; idx++)
+        {
+            if (frames[idx] != NULL)
+                unpinFrame(bm, frames[idx]);
+        }
+        pthread_mutex_unlock(&pool->latch);
+        free(frames);
+        free(loadPages);
+        return rc;
+    }
+
+    for (idx = 0; idx < numLoads; idx++)
+    {
+        __atomic_add_fetch(&pool->numOfMisses, 1, __ATOMIC_RELAXED);
+        mapFrame(pool, loads[idx], loadPages[idx]);
+    }
+    for (idx = 0; idx < numPages; idx++)
+    {
+        if (frames[idx] == NULL) //every appearance of a missing page takes its own pin
+            frames[idx] = pinResident(pool, pagePartition(&pool->bufferQueue, pageNums[idx]), pageNums[idx]);
+    }
+    for (idx = 0; idx < numLoads; idx++)
+        unpinFrame(bm, loads[idx]); //the pin that held the frame while it was taken
+    pthread_mutex_unlock(&pool->latch);
+
+    if (numLoads > 0)
+    {
+        readFrames(pool, loads, numLoads);
+        pthread_mutex_lock(&pool->latch);
+        finishLoads(bm, loads, numLoads, numLoads);
+        pthread_mutex_unlock(&pool->latch);
+    }
+
+    for (idx = 0; idx < numPages; idx++)
+    {
+        RC loadResult = waitForLoad(pool, frames[idx]); //pages other threads are still reading
+        rc = (rc == RC_OK) ? loadResult : rc;
+        handles[idx].pageNum = pageNums[idx];
+        handles[idx].data = frames[idx]->data;
+    }
+    if (rc != RC_OK)
+    {
+        //the frames are unpinned directly, the pages that could not be read have left the page table
+        pthread_mutex_lock(&pool->latch);
+        for (idx = 0; idx < numPages; idx++)
+            unpinFrame(bm, frames[idx]);
+        pthread_mutex_unlock(&pool->latch);
+    }
+    free(frames);
+    free(loadPages);
+    return rc;
+}
+
+/**
+*
+* This function will write a page from the buffer pool to disk.
+*
+*/
+RC forcePage(BM_BufferPool *const bm, BM_PageHandle *const page) //check again
+{
+    PoolManagement *pool = (PoolManagement *)bm->mgmtData;
+    PageNode *currentPageInfo = findPinnedPage(pool, page->pageNum);
+
+    if (!currentPageInfo)
+        return RC_READ_NON_EXISTING_PAGE;
+
+    //the flag is cleared before the write, so a change made meanwhile marks the page dirty again
+    pthread_rwlock_rdlock(&currentPageInfo->latch);
+    setDirtyFlag(pool, currentPageInfo, false);
+    int writeBlockOut = writeFrame(pool, currentPageInfo);
+    if (writeBlockOut)
+        setDirtyFlag(pool, currentPageInfo, true);
+    pthread_rwlock_unlock(&currentPageInfo->latch);
+    if (writeBlockOut) {
+        return RC_WRITE_FAILED;
+    }
+
+    return RC_OK;
+}
+
+
+/**
+*
+* This function marks a page in the buffer pool as dirty.
+*
+*/
+RC markDirty(BM_BufferPool *const bm, BM_PageHandle *const page) {
+    PoolManagement *pool = (PoolManagement *)bm->mgmtData;
+    PageNode *currentPageInfo = findPinnedPage(pool, page->pageNum);
+
+    if (currentPageInfo) {
+        setDirtyFlag(pool, currentPageInfo, true);
+        return RC_OK;
+    }
+
+    return RC_READ_NON_EXISTING_PAGE;
+}
+
+/**
+*
+* This function copies the page held in each frame, the dirty flag and the fix count of each frame into arrays
+* of the caller, with one entry per frame. Any of the arrays may be NULL. The frames are read from the array of
+* frames in one pass, so polling the pool allocates nothing.
+*
+*/
+RC getPoolFrames(BM_BufferPool *const bm, PageNumber *frameContents, bool *dirtyFlags, int *fixCounts)
+{
+    PoolManagement *pool = (PoolManagement *)bm->mgmtData;
+    PageNode *frames = pool->bufferQueue.frames;
+    if (frameContents != NULL)
+        pthread_mutex_lock(&pool->latch); //page numbers only change under the latch
+    for (int i = 0; i < bm->numPages; i++)
+    {
+        if (frameContents != NULL)
+            frameContents[i] = frames[i].pageNum;
+        if (dirtyFlags != NULL)
+            dirtyFlags[i] = __atomic_load_n(&frames[i].dirtyFlag, __ATOMIC_RELAXED);
+        if (fixCounts != NULL)
+            fixCounts[i] = __atomic_load_n(&frames[i].fixCount, __ATOMIC_RELAXED);
+    }
+    if (frameContents != NULL)
+        pthread_mutex_unlock(&pool->latch);
+    return RC_OK;
+}
+
+/**
+*
+* This function fills stats with the counters of the pool. They are kept up to date as pages are pinned, unpinned,
+* marked dirty and written, so reading them takes the same time for any pool size.
+*
+*/
+RC getPoolStats(BM_BufferPool *const bm, BM_PoolStats *stats)
+{
+    PoolManagement *pool = (PoolManagement *)bm->mgmtData;
+    stats->hits = __atomic_load_n(&pool->numOfHits, __ATOMIC_RELAXED);
+    stats->misses = __atomic_load_n(&pool->numOfMisses, __ATOMIC_RELAXED);
+    stats->cleanEvictions = __atomic_load_n(&pool->numOfCleanEvictions, __ATOMIC_RELAXED);
+    stats->dirtyEvictions = __atomic_load_n(&pool->numOfDirtyEvictions, __ATOMIC_RELAXED);
+    stats->evictions = stats->cleanEvictions + stats->dirtyEvictions;
+    stats->pinWaits = __atomic_load_n(&pool->numOfPinWaits, __ATOMIC_RELAXED);
+    stats->pinWaitNanos = __atomic_load_n(&pool->pinWaitNanos, __ATOMIC_RELAXED);
+    stats->numDirty = __atomic_load_n(&pool->numOfDirtyFrames, __ATOMIC_RELAXED);
+    stats->numPinned = __atomic_load_n(&pool->numOfPinnedFrames, __ATOMIC_RELAXED);
+    return RC_OK;
+}
+
+/**
+*
+* This function copies the latency histograms of the pool: how long pinPage took for pages it had to read, how long
+* the pool's writes of single pages took, and how long its batches of writes took, the writes of the background
+* writer, of forceFlushPool and of the replaced pages of pinPages. A batch is recorded once, however many pages it
+* wrote. Any of the histograms may be NULL.
+*
+*/
+RC getPoolLatencies(BM_BufferPool *const bm, BM_LatencyHistogram *pinMisses, BM_LatencyHistogram *writes, BM_LatencyHistogram *batchWrites)
+{
+    PoolManagement *pool = (PoolManagement *)bm->mgmtData;
+    BM_LatencyHistogram *sources[3] = { &pool->pinMissLatency, &pool->writeLatency, &pool->batchWriteLatency };
+    BM_LatencyHistogram *copies[3] = { pinMisses, writes, batchWrites };
+    for (int h = 0; h < 3; h++)
+    {
+        if (copies[h] == NULL)
+            continue;
+        for (int bucket = 0; bucket < BM_LATENCY_BUCKETS; bucket++)
+            copies[h]->counts[bucket] = __atomic_load_n(&sources[h]->counts[bucket], __ATOMIC_RELAXED);
+        copies[h]->count = __atomic_load_n(&sources[h]->count, __ATOMIC_RELAXED);
+        copies[h]->totalNanos = __atomic_load_n(&sources[h]->totalNanos, __ATOMIC_RELAXED);
+        copies[h]->maxNanos = __atomic_load_n(&sources[h]->maxNanos, __ATOMIC_RELAXED);
+    }
+    return RC_OK;
+}
+
+/**
+*
+* This function returns the smallest latency in nanoseconds that falls into a bucket of a latency histogram.
+*
+*/
+long getLatencyBucketStart(int bucket)
+{
+    if (bucket < BM_LATENCY_SUB_BUCKETS)
+        return bucket;
+    int highestBit = bucket / BM_LATENCY_SUB_BUCKETS + 1;
+    return (long)(BM_LATENCY_SUB_BUCKETS + bucket % BM_LATENCY_SUB_BUCKETS) << (highestBit - 2);
+}
+
+/**
+*
+* This function returns an array of page representing the page currently held in each frame of the buffer pool.
+* The array is allocated for the caller, who frees it. getPoolFrames fills an array of the caller instead.
+*
+*/
+PageNumber *getFrameContents(BM_BufferPool *const bm)
+{
+    PageNumber *pages = calloc(bm->numPages, sizeof(PageNumber));
+    if (pages != NULL)
+        getPoolFrames(bm, pages, NULL, NULL);
+    return pages;
+}
+
+/**
+*
+* This function returns reference to a boolean array that shows which pages in a buffer pool have been marked as dirty.
+* The array is allocated for the caller, who frees it.
+*
+*/
+bool *getDirtyFlags(BM_BufferPool *const bm)
+{
+    bool *dirtyFlagArray = calloc(bm->numPages, sizeof(bool));
+    if (dirtyFlagArray != NULL)
+        getPoolFrames(bm, NULL, dirtyFlagArray, NULL);
+    return dirtyFlagArray;
+}
+
+/**
+*
+* This function returns an array of fixCounts for each page in the buffer pool. The array is allocated for the
+* caller, who frees it.
+*
+*/
+int *getFixCounts(BM_BufferPool *const bm) {
 	
-	newNode->data = backupPageInfo->data;
-	newNode->frameNumber = backupPageInfo->frameNumber;
-	bufferQueue->rear->next = newNode;
-	bufferQueue->rear = newNode;
-	numOfReadOps = readBlock(pageNum, fh, newNode->data) == RC_OK?numOfReadOps+1: numOfReadOps;
-	page->data = newNode->data;
-	return RC_OK;
-}
\ No newline at end of file
+    int *fixCountsArray = calloc(bm->numPages, sizeof(int));
+    if (fixCountsArray != NULL)
+        getPoolFrames(bm, NULL, NULL, fixCountsArray);
+    return fixCountsArray;
+}
+
+
+
+/**
+*
+* This function returns the number of pages that have been read from the disk.
+*
+*/
+int getNumReadIO(BM_BufferPool *const bm)
+{
+	return __atomic_load_n(&((PoolManagement *)bm->mgmtData)->numOfReadOps, __ATOMIC_RELAXED);
+}
+
+/**
+*
+* This function returns the number of pages that have been written to the disk.
+*
+*/
+int getNumWriteIO(BM_BufferPool *const bm)
+{
+	return __atomic_load_n(&((PoolManagement *)bm->mgmtData)->numOfWriteOps, __ATOMIC_RELAXED);
+}
+
+/**
+*
+* This function pins a page in the buffer pool using LRU page replacement policy. Pages move to the rear of the
+* replacement queue whenever they are pinned, so the least recently used unpinned page is replaced first.
+*
+*/
+RC pinPageWithLRU(BM_BufferPool *const bm, BM_PageHandle *const page, const PageNumber pageNum)
+{
+	return pinPageWithStrategy(bm, page, pageNum, RS_LRU, BM_HINT_NORMAL);
+}
+
+/**
+*
+* This function pins a page in the buffer pool using FIFO page replacement policy. Pages move to the rear of the
+* replacement queue only when they are loaded, so the unpinned page loaded first is replaced first.
+*
+*/
+RC pinPageWithFIFO(BM_BufferPool *const bm, BM_PageHandle *const page, const PageNumber pageNum)
+{
+	return pinPageWithStrategy(bm, page, pageNum, RS_FIFO, BM_HINT_NORMAL);
+}
+
+/**
+*
+* This function pins a page in the buffer pool using the CLOCK (second chance) page replacement policy. Pinning a
+* page sets the reference bit of its frame, and the clock hand skips a frame once for every time its bit was set.
+*
+*/
+RC pinPageWithCLOCK(BM_BufferPool *const bm, BM_PageHandle *const page, const PageNumber pageNum)
+{
+	return pinPageWithStrategy(bm, page, pageNum, RS_CLOCK, BM_HINT_NORMAL);
+}
+
+/**
+*
+* This function pins a page in the buffer pool using the LRU-K page replacement policy. The unpinned page whose K-th
+* most recent access lies furthest back is replaced first, so pages touched once by a scan go before pages that are
+* used again and again.
+*
+*/
+RC pinPageWithLRUK(BM_BufferPool *const bm, BM_PageHandle *const page, const PageNumber pageNum)
+{
+	return pinPageWithStrategy(bm, page, pageNum, RS_LRU_K, BM_HINT_NORMAL);
+}
+
+/**
+*
+* This function pins a page in the buffer pool using the LFU page replacement policy. The unpinned page pinned the
+* fewest times is replaced first, the oldest one among equals. Frequencies are halved periodically so that pages
+* which are no longer used eventually leave the pool.
+*
+*/
+RC pinPageWithLFU(BM_BufferPool *const bm, BM_PageHandle *const page, const PageNumber pageNum)
+{
+	return pinPageWithStrategy(bm, page, pageNum, RS_LFU, BM_HINT_NORMAL);
+}
+
+/**
+*
+* This function pins a page in the buffer pool using the ARC page replacement policy. Pages seen once and pages seen
+* again are kept apart, and the split between them adapts to the ghost hits, so one long scan only churns the pages
+* seen once.
+*
+*/
+RC pinPageWithARC(BM_BufferPool *const bm, BM_PageHandle *const page, const PageNumber pageNum)
+{
+	return pinPageWithStrategy(bm, page, pageNum, RS_ARC, BM_HINT_NORMAL);
+}
+
+/**
+*
+* This function pins a page in the buffer pool using the 2Q page replacement policy. A page first goes into a small
+* FIFO queue and only enters the main LRU queue if it is asked for again after it has left the FIFO queue.
+*
+*/
+RC pinPageWith2Q(BM_BufferPool *const bm, BM_PageHandle *const page, const PageNumber pageNum)
+{
+	return pinPageWithStrategy(bm, page, pageNum, RS_2Q, BM_HINT_NORMAL);
+}
@@ -13,7 +13,9 @@ typedef enum ReplacementStrategy {
 	RS_LRU = 1,
 	RS_CLOCK = 2,
 	RS_LFU = 3,
-	RS_LRU_K = 4
+	RS_LRU_K = 4,
+	RS_ARC = 5,
+	RS_2Q = 6
 } ReplacementStrategy;
 
 // Data Types and Structures
@@ -33,6 +35,64 @@ typedef struct BM_PageHandle {
 	char *data;
 } BM_PageHandle;
 
+// stratData of RS_LRU_K pools, NULL means K = 2 without a correlated reference period
+typedef struct BM_LRUKParams {
+	int k; // number of most recent accesses the replacement decision looks at
+	int correlatedPeriod; // pins of the pool within which repeated accesses to a page count as one
+} BM_LRUKParams;
+
+// stratData of RS_LFU pools, NULL means the default aging period
+typedef struct BM_LFUParams {
+	int agingPeriod; // pins of the pool after which all use counts are halved, 0 means 8 times the pool size
+} BM_LFUParams;
+
+// stratData of RS_2Q pools, NULL or 0 means a quarter of the pool and half of the pool
+typedef struct BM_2QParams {
+	int recentFrames; // frames for pages seen once
+	int ghostEntries; // page numbers of replaced pages seen once that are remembered
+} BM_2QParams;
+
+// how a pinned page is going to be used, for pinPageWithHint
+typedef enum BM_AccessHint {
+	BM_HINT_NORMAL = 0,
+	BM_HINT_SEQUENTIAL = 1 // a page of a large scan that is read once, in page order
+} BM_AccessHint;
+
+// optional pool settings for initBufferPoolWithOptions, all zero means default
+typedef struct BM_PoolOptions {
+	bool directIO; // open the page file with O_DIRECT, the pool is the only page cache
+	bool backgroundWriter; // write unpinned dirty pages from a thread of the pool, ahead of their replacement
+	double dirtyRatio; // share of the frames the background writer leaves dirty, between 0 and 1
+	int writerIntervalMs; // milliseconds between two rounds of the background writer, 0 means BM_WRITER_INTERVAL_MS
+	int pinTimeoutMs; // milliseconds pinPage waits for a frame when all are pinned, 0 fails with RC_FULL_BUFFER at once
+} BM_PoolOptions;
+
+#define BM_WRITER_INTERVAL_MS 10
+
+// counters of a pool, for getPoolStats
+typedef struct BM_PoolStats {
+	long hits; // pins of pages found in the pool
+	long misses; // pins that read their page into the pool
+	long evictions; // pages replaced to make room for another page
+	long cleanEvictions; // replaced pages that did not have to be written
+	long dirtyEvictions; // replaced pages that were written first
+	long pinWaits; // pins that waited for a frame or for another thread reading their page
+	long pinWaitNanos; // nanoseconds those pins waited in total
+	int numDirty; // frames holding a dirty page
+	int numPinned; // frames with at least one pin
+} BM_PoolStats;
+
+// latency histogram of a pool, for getPoolLatencies. Like in an HDR histogram the buckets are log-linear: every
+// power of two of nanoseconds is split into BM_LATENCY_SUB_BUCKETS buckets, which getLatencyBucketStart tells apart
+#define BM_LATENCY_SUB_BUCKETS 4
+#define BM_LATENCY_BUCKETS 160
+typedef struct BM_LatencyHistogram {
+	long counts[BM_LATENCY_BUCKETS]; // latencies recorded per bucket
+	long count; // latencies recorded
+	long totalNanos; // sum of the latencies recorded
+	long maxNanos; // largest latency recorded
+} BM_LatencyHistogram;
+
 // convenience macros
 #define MAKE_POOL()					\
 		((BM_BufferPool *) malloc (sizeof(BM_BufferPool)))
@@ -44,8 +104,12 @@ typedef struct BM_PageHandle {
 RC initBufferPool(BM_BufferPool *const bm, const char *const pageFileName, 
 		const int numPages, ReplacementStrategy strategy,
 		void *stratData);
+RC initBufferPoolWithOptions(BM_BufferPool *const bm, const char *const pageFileName,
+		const int numPages, ReplacementStrategy strategy,
+		void *stratData, BM_PoolOptions *options);
 RC shutdownBufferPool(BM_BufferPool *const bm);
 RC forceFlushPool(BM_BufferPool *const bm);
+int getPoolPageSize(BM_BufferPool *const bm);
 
 // Buffer Manager Interface Access Pages
 RC markDirty (BM_BufferPool *const bm, BM_PageHandle *const page);
@@ -53,11 +117,25 @@ RC unpinPage (BM_BufferPool *const bm, BM_PageHandle *const page);
 RC forcePage (BM_BufferPool *const bm, BM_PageHandle *const page);
 RC pinPage (BM_BufferPool *const bm, BM_PageHandle *const page, 
 		const PageNumber pageNum);
+RC pinPageWithHint (BM_BufferPool *const bm, BM_PageHandle *const page,
+		const PageNumber pageNum, BM_AccessHint hint);
+RC pinPages (BM_BufferPool *const bm, const PageNumber *pageNums, int numPages,
+		BM_PageHandle *const handles);
+RC unpinPages (BM_BufferPool *const bm, BM_PageHandle *const handles, int numPages);
+RC prefetchPages (BM_BufferPool *const bm, PageNumber startPage, int count);
+RC latchPage (BM_BufferPool *const bm, BM_PageHandle *const page, bool exclusive);
+RC unlatchPage (BM_BufferPool *const bm, BM_PageHandle *const page);
 
 // Statistics Interface
 PageNumber *getFrameContents (BM_BufferPool *const bm);
 bool *getDirtyFlags (BM_BufferPool *const bm);
 int *getFixCounts (BM_BufferPool *const bm);
+RC getPoolFrames (BM_BufferPool *const bm, PageNumber *frameContents, bool *dirtyFlags,
+		int *fixCounts);
+RC getPoolStats (BM_BufferPool *const bm, BM_PoolStats *stats);
+RC getPoolLatencies (BM_BufferPool *const bm, BM_LatencyHistogram *pinMisses,
+		BM_LatencyHistogram *writes, BM_LatencyHistogram *batchWrites);
+long getLatencyBucketStart (int bucket);
 int getNumReadIO (BM_BufferPool *const bm);
 int getNumWriteIO (BM_BufferPool *const bm);
 
@@ -1,11 +1,15 @@
 #include "buffer_mgr_stat.h"
 #include "buffer_mgr.h"
 
+#include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 
 // local functions
 static void printStrat (BM_BufferPool *const bm);
+static const char *stratName (ReplacementStrategy strategy);
+static size_t appendMessage (char *message, size_t size, size_t pos, const char *format, ...);
+static size_t sprintLatencies (char *message, size_t size, size_t pos, const char *name, BM_LatencyHistogram *histogram);
 
 // external functions
 void 
@@ -16,9 +20,10 @@ printPoolContent (BM_BufferPool *const bm)
 	int *fixCount;
 	int i;
 
-	frameContent = getFrameContents(bm);
-	dirty = getDirtyFlags(bm);
-	fixCount = getFixCounts(bm);
+	frameContent = (PageNumber *) malloc(sizeof(PageNumber) * bm->numPages);
+	dirty = (bool *) malloc(sizeof(bool) * bm->numPages);
+	fixCount = (int *) malloc(sizeof(int) * bm->numPages);
+	getPoolFrames(bm, frameContent, dirty, fixCount);
 
 	printf("{");
 	printStrat(bm);
@@ -27,6 +32,10 @@ printPoolContent (BM_BufferPool *const bm)
 	for (i = 0; i < bm->numPages; i++)
 		printf("%s[%i%s%i]", ((i == 0) ? "" : ",") , frameContent[i], (dirty[i] ? "x": " "), fixCount[i]);
 	printf("\n");
+
+	free(frameContent);
+	free(dirty);
+	free(fixCount);
 }
 
 char *
@@ -40,13 +49,17 @@ sprintPoolContent (BM_BufferPool *const bm)
 	int pos = 0;
 
 	message = (char *) malloc(256 + (22 * bm->numPages));
-	frameContent = getFrameContents(bm);
-	dirty = getDirtyFlags(bm);
-	fixCount = getFixCounts(bm);
+	frameContent = (PageNumber *) malloc(sizeof(PageNumber) * bm->numPages);
+	dirty = (bool *) malloc(sizeof(bool) * bm->numPages);
+	fixCount = (int *) malloc(sizeof(int) * bm->numPages);
+	getPoolFrames(bm, frameContent, dirty, fixCount);
 
 	for (i = 0; i < bm->numPages; i++)
 		pos += sprintf(message + pos, "%s[%i%s%i]", ((i == 0) ? "" : ",") , frameContent[i], (dirty[i] ? "x": " "), fixCount[i]);
 
+	free(frameContent);
+	free(dirty);
+	free(fixCount);
 	return message;
 }
 
@@ -78,28 +91,147 @@ sprintPageContent (BM_PageHandle *const page)
 	return message;
 }
 
+// returns the latency below which the given share of the latencies of a histogram fall, in nanoseconds, as the end
+// of the bucket it falls into but no more than the largest latency recorded
+long
+getLatencyPercentile (BM_LatencyHistogram *const histogram, double percentile)
+{
+	long rank, seen = 0;
+	int i;
+
+	if (histogram->count == 0)
+		return 0;
+	rank = (long) (percentile / 100.0 * histogram->count + 0.5);
+	if (rank < 1)
+		rank = 1;
+	for (i = 0; i < BM_LATENCY_BUCKETS - 1; i++)
+	{
+		seen += histogram->counts[i];
+		if (seen >= rank)
+			break;
+	}
+	if (i == BM_LATENCY_BUCKETS - 1 || getLatencyBucketStart(i + 1) > histogram->maxNanos)
+		return histogram->maxNanos;
+	return getLatencyBucketStart(i + 1);
+}
+
+void
+printPoolStats (BM_BufferPool *const bm)
+{
+	char *message = sprintPoolStats(bm);
+
+	if (message == NULL)
+		return;
+	printf("%s", message);
+	free(message);
+}
+
+// dump of the counters and latency histograms of a pool, one line of counters, then for each histogram a line of
+// percentiles in microseconds followed by a line per bucket that is not empty
+char *
+sprintPoolStats (BM_BufferPool *const bm)
+{
+	BM_PoolStats stats;
+	BM_LatencyHistogram pinMisses, writes, batchWrites;
+	const char *name = stratName(bm->strategy);
+	char *message;
+	size_t size = 1024 + 3 * 64 * BM_LATENCY_BUCKETS;
+	size_t pos = 0;
+
+	message = (char *) malloc(size);
+	if (message == NULL)
+		return NULL;
+	message[0] = '\0';
+	getPoolStats(bm, &stats);
+	getPoolLatencies(bm, &pinMisses, &writes, &batchWrites);
+
+	if (name != NULL)
+		pos = appendMessage(message, size, pos, "{%s %i}: ", name, bm->numPages);
+	else
+		pos = appendMessage(message, size, pos, "{%i %i}: ", bm->strategy, bm->numPages);
+	pos = appendMessage(message, size, pos, "hits %li, misses %li, evictions %li (clean %li, dirty %li), "
+			"dirty frames %i, pinned frames %i, reads %i, writes %i\n",
+			stats.hits, stats.misses, stats.evictions, stats.cleanEvictions, stats.dirtyEvictions,
+			stats.numDirty, stats.numPinned, getNumReadIO(bm), getNumWriteIO(bm));
+	pos = appendMessage(message, size, pos, "pin waits %li, %.1f us waited\n", stats.pinWaits, stats.pinWaitNanos / 1000.0);
+	pos = sprintLatencies(message, size, pos, "pinPage misses", &pinMisses);
+	pos = sprintLatencies(message, size, pos, "writeBlock", &writes);
+	pos = sprintLatencies(message, size, pos, "batched writes", &batchWrites);
+
+	return message;
+}
+
+// appends formatted text at pos to message, a buffer of size bytes, and returns the new end of the text;
+// text that does not fit is cut off
+static size_t
+appendMessage (char *message, size_t size, size_t pos, const char *format, ...)
+{
+	va_list args;
+	int written;
+
+	if (pos + 1 >= size)
+		return pos;
+	va_start(args, format);
+	written = vsnprintf(message + pos, size - pos, format, args);
+	va_end(args);
+	if (written < 0)
+		return pos;
+	return (pos + written < size) ? pos + written : size - 1;
+}
+
+static size_t
+sprintLatencies (char *message, size_t size, size_t pos, const char *name, BM_LatencyHistogram *histogram)
+{
+	int i;
+
+	pos = appendMessage(message, size, pos, "%s: count %li", name, histogram->count);
+	if (histogram->count > 0)
+		pos = appendMessage(message, size, pos, ", mean %.1f us, p50 %.1f us, p90 %.1f us, p99 %.1f us, max %.1f us",
+				histogram->totalNanos / 1000.0 / histogram->count,
+				getLatencyPercentile(histogram, 50) / 1000.0, getLatencyPercentile(histogram, 90) / 1000.0,
+				getLatencyPercentile(histogram, 99) / 1000.0, histogram->maxNanos / 1000.0);
+	pos = appendMessage(message, size, pos, "\n");
+
+	for (i = 0; i < BM_LATENCY_BUCKETS; i++)
+		if (histogram->counts[i] > 0)
+			pos = appendMessage(message, size, pos, "  [%.3f us, %.3f us) %li\n", getLatencyBucketStart(i) / 1000.0,
+					(i < BM_LATENCY_BUCKETS - 1) ? getLatencyBucketStart(i + 1) / 1000.0 : histogram->maxNanos / 1000.0,
+					histogram->counts[i]);
+
+	return pos;
+}
+
 void
 printStrat (BM_BufferPool *const bm)
 {
-	switch (bm->strategy)
+	const char *name = stratName(bm->strategy);
+
+	if (name != NULL)
+		printf("%s", name);
+	else
+		printf("%i", bm->strategy);
+}
+
+static const char *
+stratName (ReplacementStrategy strategy)
+{
+	switch (strategy)
 	{
 	case RS_FIFO:
-		printf("FIFO");
-		break;
+		return "FIFO";
 	case RS_LRU:
-		printf("LRU");
-		break;
+		return "LRU";
 	case RS_CLOCK:
-		printf("CLOCK");
-		break;
+		return "CLOCK";
 	case RS_LFU:
-		printf("LFU");
-		break;
+		return "LFU";
 	case RS_LRU_K:
-		printf("LRU-K");
-		break;
+		return "LRU-K";
+	case RS_ARC:
+		return "ARC";
+	case RS_2Q:
+		return "2Q";
 	default:
-		printf("%i", bm->strategy);
-		break;
+		return NULL;
 	}
 }
@@ -9,4 +9,9 @@ void printPageContent (BM_PageHandle *const page);
 char *sprintPoolContent (BM_BufferPool *const bm);
 char *sprintPageContent (BM_PageHandle *const page);
 
+// counters and latency histograms of a pool
+void printPoolStats (BM_BufferPool *const bm);
+char *sprintPoolStats (BM_BufferPool *const bm);
+long getLatencyPercentile (BM_LatencyHistogram *const histogram, double percentile);
+
 #endif
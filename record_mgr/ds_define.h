@@ -1,4 +1,6 @@
 #include "buffer_mgr.h"
+#include "storage_mgr.h"
+#include <pthread.h>
 #include "record_mgr.h"
 
 #define MAX_TOMBSTONED_RIDS 10000
@@ -16,18 +18,180 @@ typedef struct PageNode
    int frameNumber;
    int fixCount;
    bool dirtyFlag;
+   bool referenceBit;
+   bool ioInProgress;
+   RC loadResult;
+   bool scanned;
+   pthread_rwlock_t latch;
+   int heapIndex;
+   long lastAccess;
+   long *history;
+   struct FrequencyBucket *bucket;
+   struct FrameList *list;
    struct PageNode *next;
    struct PageNode *prev;
 } PageNode;
 
+/*
+The page table maps the number of every page held in the pool to its frame. It is an open-addressing hash table
+with linear probing, so finding a page takes constant time however many frames the pool has. A slot is empty
+while its pageNode is NULL. The page table of a pool is split into BM_PAGE_TABLE_PARTITIONS partitions by page
+number, each guarded by its own lock.
+*/
+#define BM_PAGE_TABLE_PARTITIONS 8
+
+typedef struct PageTableEntry
+{
+   int pageNum;
+   PageNode *pageNode;
+} PageTableEntry;
+
+typedef struct PageTable
+{
+   PageTableEntry *entries;
+   int capacity;
+   pthread_mutex_t lock;
+} PageTable;
+
+// frames pinned equally often, oldest first, for LFU
+typedef struct FrequencyBucket
+{
+   long frequency;
+   PageNode *first;
+   PageNode *last;
+   struct FrequencyBucket *next;
+   struct FrequencyBucket *prev;
+} FrequencyBucket;
+
+// a list of frames, or of ghost entries that only keep a page number, for ARC and 2Q
+typedef struct FrameList
+{
+   PageNode *first;
+   PageNode *last;
+   int size;
+} FrameList;
+
+// the asynchronous read or write of a frame and the result of its I/O, bm is the pool of a detached read
+typedef struct FrameIO
+{
+   PageNode *pageNode;
+   RC result;
+   BM_BufferPool *bm;
+} FrameIO;
+
+/*
+The frames of a pool are allocated once, as the frames array with their data in frameArena. All of them are linked
+into the replacement queue, the next page to be replaced is looked for from the front and pages move to the rear
+when they are loaded.
+CLOCK instead sweeps clockHand over the frames array, giving frames whose referenceBit is set a second chance.
+LRU-K keeps the unpinned frames in heap, a binary heap ordered by the K-th most recent access in their history.
+LFU links the frames of equal frequency through next and prev into a FrequencyBucket instead, starting at
+lowestBucket, and takes buckets from spareBuckets. lastAccess then holds the accessClock at which a frame entered
+its bucket.
+ARC and 2Q link the frames into residentLists through next and prev, pages seen once in the first list and pages
+seen again in the second, and keep ghosts of replaced pages in ghostLists, found through ghostTable.
+Pages of sequential scans are loaded into the frames of scanRing, which is reused from scanRingNext once all of its
+scanRingSize slots are filled. Their frames are marked scanned until the page is pinned other than by a scan.
+A frame has at most one read or write in flight, frameIO holds one FrameIO per frame for it. skippedFrames is
+scratch space of LRU-K for the frames it passes over while picking a victim, under the pool latch, and writerOrder
+that of the background writer for the frames in replacement order.
+*/
 typedef struct BufferQueue
 {
    PageNode *front;
    PageNode *rear;
    int numOfFilledFrames;
    int frameCount;
+   PageNode *frames;
+   char *frameArena;
+   int clockHand;
+   PageNode **heap;
+   int heapSize;
+   long *history;
+   int k;
+   int correlatedPeriod;
+   long accessClock;
+   FrequencyBucket *buckets;
+   FrequencyBucket *spareBuckets;
+   FrequencyBucket *lowestBucket;
+   int agingPeriod;
+   int pinsSinceAging;
+   FrameList residentLists[2];
+   FrameList ghostLists[2];
+   FrameList freeFrames;
+   FrameList *loadList;
+   PageNode *ghosts;
+   PageNode *spareGhosts;
+   PageTable ghostTable;
+   int recentTarget;
+   int ghostLimit;
+   PageNode **scanRing;
+   int scanRingSize;
+   int scanRingCount;
+   int scanRingNext;
+   PageTable pageTable[BM_PAGE_TABLE_PARTITIONS];
+   FrameIO *frameIO;
+   PageNode **skippedFrames;
+   PageNode **writerOrder;
 } BufferQueue;
 
+// a thread waiting in pinPage or pinPages for frames to be unpinned
+typedef struct FrameWaiter
+{
+   struct FrameWaiter *next;
+} FrameWaiter;
+
+// what findVictim does with the dirty page of the frame it picks
+typedef enum VictimWrite
+{
+   VICTIM_WRITE = 0, // the page is written before the frame is handed out
+   VICTIM_KEEP_DIRTY = 1, // the page stays in the pool and no frame is handed out
+   VICTIM_DEFER_WRITE = 2 // the frame is handed out unwritten, the caller writes the page under the pool latch
+} VictimWrite;
+
+/*
+Everything the buffer manager keeps about one buffer pool, stored in its mgmtData: the page file the pool caches,
+its frames and the number of pages read and written so far. latch serializes the replacement strategy and
+frameLoaded is signalled whenever the I/O of frames marked ioInProgress is done. numOfDetachedReads counts the
+pages being read ahead in the background, which complete on the I/O workers. A pool with a background writer runs
+it as writer, woken up through writerWakeup every writerInterval milliseconds or when a page had to be written at replacement.
+Threads waiting for a frame to be unpinned queue up from firstWaiter to lastWaiter and wait on frameFreed.
+lastMissPage and sequentialMisses track runs of misses of consecutive pages, which make pinPage read ahead.
+*/
+typedef struct PoolManagement
+{
+   SM_FileHandle fh;
+   BufferQueue bufferQueue;
+   int numOfReadOps;
+   int numOfWriteOps;
+   long numOfHits;
+   long numOfMisses;
+   long numOfCleanEvictions;
+   long numOfDirtyEvictions;
+   long numOfPinWaits;
+   long pinWaitNanos;
+   int numOfDirtyFrames;
+   int numOfPinnedFrames;
+   BM_LatencyHistogram pinMissLatency;
+   BM_LatencyHistogram writeLatency;
+   BM_LatencyHistogram batchWriteLatency;
+   pthread_mutex_t latch;
+   pthread_cond_t frameLoaded;
+   pthread_t writer;
+   pthread_cond_t writerWakeup;
+   bool writerRunning;
+   bool stopWriter;
+   double dirtyRatio;
+   int writerInterval;
+   int pinTimeout;
+   FrameWaiter *firstWaiter;
+   FrameWaiter *lastWaiter;
+   pthread_cond_t frameFreed;
+   PageNumber lastMissPage;
+   int sequentialMisses;
+   int numOfDetachedReads;
+} PoolManagement;
+
 typedef struct TableManagement
 {
     int recordSize;
@@ -53,6 +217,11 @@ typedef struct ScanManagement
 
 RC pinPageWithLRU(BM_BufferPool *const bm, BM_PageHandle *const page, const PageNumber pageNum);
 RC pinPageWithFIFO(BM_BufferPool *const bm, BM_PageHandle *const page, const PageNumber pageNum);
+RC pinPageWithCLOCK(BM_BufferPool *const bm, BM_PageHandle *const page, const PageNumber pageNum);
+RC pinPageWithLRUK(BM_BufferPool *const bm, BM_PageHandle *const page, const PageNumber pageNum);
+RC pinPageWithLFU(BM_BufferPool *const bm, BM_PageHandle *const page, const PageNumber pageNum);
+RC pinPageWithARC(BM_BufferPool *const bm, BM_PageHandle *const page, const PageNumber pageNum);
+RC pinPageWith2Q(BM_BufferPool *const bm, BM_PageHandle *const page, const PageNumber pageNum);
 
 void schemaReadFromFile(RM_TableData *, BM_PageHandle *);
 
@@ -66,7 +235,7 @@ char *readFreePageSlotData(char *);
 char *extractName(char *);
 char *getSingleAttributeData(char *, int);
 void strRepInt(int position, int value, char *result);
-int tombstonedRIDs[MAX_TOMBSTONED_RIDS];
+extern int tombstonedRIDs[MAX_TOMBSTONED_RIDS];
 int readTotalKeyAttribute(char *);
 int extractDataType(char *);
 int *getAttributeDataType(char *, int);
@@ -33,6 +33,11 @@ typedef int RC;
 #define RC_FILE_NOT_OPENED 97
 #define RC_FILE_NOT_CLOSED 96
 #define RC_INVALID_PAGE_RANGE 95
+#define RC_MAP_FAILED 76
+#define RC_INVALID_PAGE_SIZE 75
+#define RC_INVALID_PAGE_FILE 74
+#define RC_FREE_PAGE_FAILED 73
+#define RC_CHECKSUM_MISMATCH 72
 
 /* holder for error messages */
 extern char *RC_message;
@@ -16,6 +16,9 @@
 *  @author Gabriel Baranes (A20521263) - gbaranes@hawk.iit.edu
 */
 
+// pread/pwrite and mmap are hidden by a strict -std=c99 build, mremap is Linux-only
+#define _GNU_SOURCE
+
 // user-defined libraries
 #include "storage_mgr.h"
 #include "dberror.h"
@@ -25,327 +28,2161 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <limits.h>
+#include <stdint.h>
+#include <pthread.h>
 
-FILE *file;
+/* maximum number of descriptors the open-file table keeps open at once */
+#define SM_MAX_OPEN_DESCRIPTORS 64
 
-// Here we are initializing the Storage manager
-void initStorageManager(void)
+/* a page file grows by at least this many bytes, or a tenth of its size if that is more */
+#define SM_MIN_EXTENT_SIZE (1 << 20)
+
+/* smallest mapping of a memory-mapped page file in pages, mappings grow by doubling */
+#define SM_MIN_MAPPED_PAGES 256
+
+/* magic number at the start of the superblock of every page file, "DBPF" */
+#define SM_FILE_MAGIC 0x46504244
+
+/* layout version of the superblock, bumped whenever the on-disk format changes */
+#define SM_FILE_VERSION 2
+
+/* size of the trailer holding the CRC32C of a page in files created with SM_FILE_CHECKSUMS */
+#define SM_CHECKSUM_SIZE 4
+
+/* CRC32C (Castagnoli) polynomial, bit-reversed */
+#define SM_CRC32C_POLY 0x82F63B78
+
+/**
+*
+* The superblock kept in the first page slot of every page file, in front of page 0. It records the
+* page size and flags chosen when the file was created, so page I/O never has to assume PAGE_SIZE,
+* the number of pages of the file, the root pages registered by higher layers and, in the rest of the slot, a
+* bitmap with one bit per page that is set while the page is free.
+*
+*/
+typedef struct SM_Superblock
 {
-	printf("\n~~~~~~~~~~~~<STORAGE MANAGER LOADING>~~~~~~~~~~~~");
+	uint32_t magic;
+	uint32_t version;
+	uint32_t pageSize;
+	uint32_t flags;
+	int32_t numPages;
+	int32_t numFreePages;
+	int32_t rootPages[SM_NUM_ROOT_PAGES];
+	uint8_t freeMap[];
+} SM_Superblock;
+
+/* number of worker threads serving asynchronous page reads and writes */
+#define SM_IO_THREADS 4
+
+/* most pages moved by a single preadv/pwritev call */
+#ifdef IOV_MAX
+#define SM_MAX_VECTORED_PAGES IOV_MAX
+#else
+#define SM_MAX_VECTORED_PAGES 1024
+#endif
+
+/**
+*
+* One entry of the process-wide open-file table. Every SM_FileHandle opened on
+* the same file points to the same entry through its mgmtInfo, so all state of
+* an open file lives here. The entries are kept in a list ordered from the most
+* to the least recently used one.
+*
+* fd is -1 while the descriptor is closed. Descriptors are cached after the last
+* handle is closed, so re-opening a file costs no system call, and the least
+* recently used descriptors are closed once more than SM_MAX_OPEN_DESCRIPTORS
+* are open. They are re-opened on the next access.
+*
+* mapping is set once the file is opened with SM_MODE_MMAP. From then on pages
+* of the file are copied from and to the shared mapping instead of going through
+* pread/pwrite. The mapping survives its descriptor being closed by the LRU.
+*
+* pageStride is the distance between two pages in the file. It is the page size,
+* plus the CRC32C trailer of each page if the file was created with
+* SM_FILE_CHECKSUMS. Pages of such files are checked on every read.
+*
+* Files grow in extents preallocated with posix_fallocate. allocatedPages is the
+* number of pages known to exist on disk, pages between totalNumPages and
+* allocatedPages are preallocated and still zero, so appending one of them is
+* only a matter of counting it.
+*
+* superblock is the in-memory copy of the first page slot of the file. Its page
+* count, the logical size of the file, is kept in totalNumPages while the file is open. Whenever an extent is
+* reserved, the superblock is written with the count rounded up to allocatedPages, so the count on disk always
+* covers the pages written so far. The exact count and the rest of the superblock are written back when the last
+* handle is closed or the descriptor is closed by the LRU.
+*
+* directIO is set while the file is opened with SM_MODE_DIRECT. Its descriptor
+* then bypasses the OS page cache, and page buffers that are not aligned to
+* SM_IO_ALIGNMENT are bounced through an aligned one.
+*
+* The table and its entries are guarded by fileTableLock, so handles can be used
+* from several threads. Reads and writes of pages of a file that is not mapped
+* run without the lock, ioInFlight keeps the descriptor open meanwhile.
+*
+*/
+typedef struct SM_FileInfo
+{
+	char *fileName;
+	int fd;
+	int refCount;
+	int pageSize;
+	int pageStride;
+	bool checksums;
+	int totalNumPages;
+	int allocatedPages;
+	SM_Superblock *superblock;
+	bool superblockDirty;
+	char *mapping;
+	size_t mappingSize;
+	bool directIO;
+	int ioInFlight;
+	struct SM_FileInfo *prev;
+	struct SM_FileInfo *next;
+} SM_FileInfo;
+
+static SM_FileInfo *openFileTableFront = NULL;
+static SM_FileInfo *openFileTableRear = NULL;
+static int numOfOpenDescriptors = 0;
+static pthread_mutex_t fileTableLock;
+static pthread_once_t fileTableLockOnce = PTHREAD_ONCE_INIT;
+
+/**
+*
+* This function creates fileTableLock. The lock is recursive, since the public functions that take it
+* call each other, allocatePage calling appendEmptyBlock for one.
+*
+*/
+static void initFileTableLock(void)
+{
+	pthread_mutexattr_t attr;
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&fileTableLock, &attr);
+	pthread_mutexattr_destroy(&attr);
+}
+
+static void lockFileTable(void)
+{
+	pthread_once(&fileTableLockOnce, initFileTableLock);
+	pthread_mutex_lock(&fileTableLock);
+}
+
+static void unlockFileTable(void)
+{
+	pthread_mutex_unlock(&fileTableLock);
 }
 
 /**
 *
-*  This function creates a page file, that file is opened in write mode "w+",
-*  If the file is successfully opened, a block of memory with PAGE_SIZE is
-*  allocated and initialized with the null character. The block is then
-*  written to the file using fwrite. Finally, the memory is freed and the
-*  file is closed. If the file can not be opened, the function returns the
-*  error code as RC_FILE_NOT_FOUND.
+* This function is called with fileTableLock held right before pages of a file are read or written. Unless
+* the file is mapped, whose mapping may move when another thread grows it, the lock is released for the I/O
+* and the descriptor is kept open through ioInFlight. The result is handed to endPageIO afterwards.
 *
 */
-RC createPageFile(char *fName)
+static bool beginPageIO(SM_FileInfo *fileInfo)
 {
-	file = fopen(fName, "w+");
-	if (file)
+	if (fileInfo->mapping != NULL)
 	{
-		char *emptyBlock = malloc(PAGE_SIZE * sizeof(char));
-		memset(emptyBlock, '\0', PAGE_SIZE);
-		fwrite(emptyBlock, sizeof(char), PAGE_SIZE, file);
-		free(emptyBlock);
-		printf("\ncreatePageFile() Executed successfully!\n");
-		fclose(file);
-		return RC_OK;
+		return false;
 	}
-    printf("\nDesired file can not be accessed due to an Error!!!\n");
-    printf("\nERROR CODE : RC_FILE_NOT_FOUND\n");
+	fileInfo->ioInFlight++;
+	unlockFileTable();
+	return true;
+}
 
-	return RC_FILE_NOT_FOUND;
+/**
+*
+* This function takes fileTableLock back after the I/O started with beginPageIO.
+*
+*/
+static void endPageIO(SM_FileInfo *fileInfo, bool unlocked)
+{
+	if (unlocked)
+	{
+		lockFileTable();
+		fileInfo->ioInFlight--;
+	}
 }
 
 /**
 *
-* This function opens the desired Page File with the name as fName.
+* This function looks up the open-file table entry for fileName, NULL if the file is not in the table.
 *
 */
-RC openPageFile(char *fName, SM_FileHandle *fHandle)
+static SM_FileInfo *findFileInfo(const char *fileName)
 {
-	file = fopen(fName, "r+");
-	if (file)
+	SM_FileInfo *fileInfo = openFileTableFront;
+	while (fileInfo != NULL && strcmp(fileInfo->fileName, fileName) != 0)
 	{
-		fseek(file, 0, SEEK_END); //moving the file pointer to end of the file
-		int lastByte = ftell(file); //assigning the current pointer of the file to the lastByte
-		int fileLength = lastByte + 1; //calculating the total length of the file
-		int nPages = fileLength / PAGE_SIZE;
+		fileInfo = fileInfo->next;
+	}
+	return fileInfo;
+}
 
-		fHandle->fileName = fName;
-		fHandle->totalNumPages = nPages;
-		fHandle->curPagePos = 0;
+/**
+*
+* This function unlinks an entry from the open-file table.
+*
+*/
+static void unlinkFileInfo(SM_FileInfo *fileInfo)
+{
+	if (fileInfo->prev)
+		fileInfo->prev->next = fileInfo->next;
+	else
+		openFileTableFront = fileInfo->next;
 
-		rewind(file); // Moving the file pointer back to the beginning of the file
-		printf("\nopenPageFile() Executed successfully!\n");
-		return RC_OK;
-	}
-    printf("\nDesired file can not be accesses due to an Error!!!\n");
-    printf("\nERROR CODE : RC_FILE_NOT_FOUND\n");
+	if (fileInfo->next)
+		fileInfo->next->prev = fileInfo->prev;
+	else
+		openFileTableRear = fileInfo->prev;
 
-	return RC_FILE_NOT_FOUND;
+	fileInfo->prev = fileInfo->next = NULL;
 }
 
 /**
 *
-* This function Closes the page file associated with the SM_FileHandle fHandle
+* This function puts an entry at the front (most recently used end) of the open-file table.
 *
 */
-RC closePageFile(SM_FileHandle *fHandle)
+static void linkFileInfoAtFront(SM_FileInfo *fileInfo)
 {
-	RC fileOpenCloseFlag = fclose(file);
-    file = NULL;
-	return (fileOpenCloseFlag == 0) ? RC_OK : RC_FAILED_CLOSE;
+	fileInfo->prev = NULL;
+	fileInfo->next = openFileTableFront;
+	if (openFileTableFront)
+		openFileTableFront->prev = fileInfo;
+	else
+		openFileTableRear = fileInfo;
+	openFileTableFront = fileInfo;
 }
 
 /**
 *
-* This function distroys the page file associated with the file name fileName
+* This function writes the superblock of an open file to its first page slot through fd, with numPages as its page count.
 *
 */
-RC destroyPageFile(char *fileName)
+static RC writeSuperblock(SM_FileInfo *fileInfo, int fd, int numPages)
 {
-    if(file == NULL){
-        return (remove(fileName) == 0) ? RC_OK : RC_FAILED_REMOVAL;
-    }
-    printf("File can only be destroyed if it is CLOSED");
-    return RC_FILE_NOT_CLOSED;
-	
+	fileInfo->superblock->numPages = numPages;
+	if (pwrite(fd, fileInfo->superblock, fileInfo->pageSize, 0) != fileInfo->pageSize)
+	{
+		return RC_WRITE_FAILED;
+	}
+	return RC_OK;
 }
 
 /**
 *
-* This function reads the block associated with the SM_FileHandle fHandle
+* This function writes the superblock of an open file back to its first page slot if it changed.
 *
 */
-RC readBlock(int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage)
+static RC flushSuperblock(SM_FileInfo *fileInfo)
 {
-    if(fHandle == NULL){
-        return RC_FILE_NOT_FOUND;
-    }
-
-	if (fHandle->totalNumPages < pageNum) //If page number is out of range, it will throw an error
+	if (!fileInfo->superblockDirty && fileInfo->superblock->numPages == fileInfo->totalNumPages)
 	{
-        printf("\nThere is an Error in reading a Block!!!\n");
-        printf("\nERROR CODE : RC_READ_NON_EXISTING_PAGE\n");  
-		return RC_READ_NON_EXISTING_PAGE;
+		return RC_OK;
 	}
-    if(file){
-        fseek(file, pageNum * PAGE_SIZE, SEEK_SET);
-	    fread(memPage, sizeof(char), PAGE_SIZE, file); //reading the stream from file and to memPage
-	    fHandle->curPagePos = pageNum; //updating the current page position to page number
-        printf("\nRead operation completed successfully for the desired block!\n");
-        return RC_OK;
-    }
-    return RC_FILE_NOT_OPENED;
+	if (writeSuperblock(fileInfo, fileInfo->fd, fileInfo->totalNumPages) != RC_OK)
+	{
+		return RC_WRITE_FAILED;
+	}
+	fileInfo->superblockDirty = false;
+	return RC_OK;
 }
 
 /**
 *
-* This function will return the position of current block associated with the fHandle
+* This function closes the descriptor of an entry and drops the entry from the table if no handle uses it anymore.
+* A superblock that changed is written back first, re-opening the descriptor if the LRU has closed it already.
+* Returns the result of writing the superblock. An entry with I/O in flight is left alone, since its requests still
+* use the descriptor and the entry, and RC_FILE_NOT_CLOSED is returned.
 *
 */
-int getBlockPos(SM_FileHandle *fHandle)
+static RC releaseFileInfo(SM_FileInfo *fileInfo)
 {
-    printf("\nCurrent position of the block returned successfully!\n");
-	return fHandle?(fHandle->curPagePos):RC_FILE_NOT_FOUND;
+	RC rc = RC_OK;
+	if (fileInfo->ioInFlight > 0)
+	{
+		return RC_FILE_NOT_CLOSED;
+	}
+	if (fileInfo->fd < 0 && (fileInfo->superblockDirty || fileInfo->superblock->numPages != fileInfo->totalNumPages))
+	{
+		fileInfo->fd = open(fileInfo->fileName, O_RDWR);
+		if (fileInfo->fd >= 0)
+			numOfOpenDescriptors++;
+		else
+			rc = RC_WRITE_FAILED;
+	}
+	if (fileInfo->fd >= 0)
+	{
+		rc = flushSuperblock(fileInfo);
+		close(fileInfo->fd);
+		fileInfo->fd = -1;
+		numOfOpenDescriptors--;
+	}
+	if (fileInfo->refCount == 0)
+	{
+		if (fileInfo->mapping)
+			munmap(fileInfo->mapping, fileInfo->mappingSize);
+		unlinkFileInfo(fileInfo);
+		free(fileInfo->superblock);
+		free(fileInfo->fileName);
+		free(fileInfo);
+	}
+	return rc;
 }
 
 /**
 *
-* This function reads the first block associated with the fHandle
+* This function closes least recently used descriptors until the open-file table is back under its limit.
+* The entry given as keep is about to be used and is never closed.
 *
 */
-RC readFirstBlock(SM_FileHandle *fHandle, SM_PageHandle memPage)
+static void closeIdleDescriptors(SM_FileInfo *keep)
 {
-	return fHandle?readBlock(0, fHandle, memPage):RC_FILE_NOT_FOUND;
+	SM_FileInfo *fileInfo = openFileTableRear;
+	while (numOfOpenDescriptors > SM_MAX_OPEN_DESCRIPTORS && fileInfo != NULL)
+	{
+		SM_FileInfo *prev = fileInfo->prev;
+		if (fileInfo != keep && fileInfo->fd >= 0 && fileInfo->ioInFlight == 0)
+		{
+			releaseFileInfo(fileInfo);
+		}
+		fileInfo = prev;
+	}
 }
 
 /**
 *
-* This function reads the previous block, position of the previous block can
-* not be less than zero. if it is less than zero it will throw an error
+* This function switches the descriptor of an entry in or out of direct I/O. On file systems that do
+* not support O_DIRECT (tmpfs for one) the descriptor simply keeps using the page cache.
 *
 */
-RC readPreviousBlock(SM_FileHandle *fHandle, SM_PageHandle memPage)
+static void applyDirectIO(SM_FileInfo *fileInfo, int fd)
 {
+#if defined(O_DIRECT)
+	int flags = fcntl(fd, F_GETFL);
+	if (flags >= 0)
+		fcntl(fd, F_SETFL, fileInfo->directIO ? (flags | O_DIRECT) : (flags & ~O_DIRECT));
+#elif defined(F_NOCACHE)
+	fcntl(fd, F_NOCACHE, fileInfo->directIO ? 1 : 0);
+#endif
+}
 
-	if (fHandle){
-		RC previousBlockPosition;
-		previousBlockPosition = fHandle->curPagePos - 1;
-
-		if (previousBlockPosition < 0){
-            printf("\nPosition of the previous block can not be accessed due to an Error!!!\n");
-            printf("\nERROR CODE : RC_READ_NON_EXISTING_PAGE\n");
-			return RC_READ_NON_EXISTING_PAGE;
+/**
+*
+* This function returns the descriptor of an opened handle, or -1 when the handle has not been opened
+* (or was already closed). A descriptor closed by the LRU is re-opened here, and the entry becomes
+* the most recently used one.
+*
+*/
+static int getFileDescriptor(SM_FileHandle *fHandle)
+{
+	if (fHandle == NULL || fHandle->mgmtInfo == NULL)
+	{
+		return -1;
+	}
+	SM_FileInfo *fileInfo = (SM_FileInfo *)fHandle->mgmtInfo;
+	if (fileInfo->fd < 0)
+	{
+		fileInfo->fd = open(fileInfo->fileName, O_RDWR);
+		if (fileInfo->fd < 0)
+		{
+			return -1;
 		}
-        printf("\nRead operation completed successfully for the previous block!\n");
-		return readBlock(previousBlockPosition, fHandle, memPage);
+		numOfOpenDescriptors++;
+		closeIdleDescriptors(fileInfo);
+		if (fileInfo->directIO)
+			applyDirectIO(fileInfo, fileInfo->fd);
 	}
-    printf("\nRead operation can not be completed due to an Error!!!\n");
-    printf("\nERROR CODE : RC_FILE_NOT_FOUND\n");
-	return RC_FILE_NOT_FOUND;
+	if (fileInfo != openFileTableFront)
+	{
+		unlinkFileInfo(fileInfo);
+		linkFileInfoAtFront(fileInfo);
+	}
+	fHandle->totalNumPages = fileInfo->totalNumPages; //another handle on the same file may have grown it
+	return fileInfo->fd;
+}
+
+/**
+*
+* This function records a new page count for the file of fHandle, in the handle and in the shared entry.
+* The count is only kept in memory. Every page it covers lies inside an extent reserved with reserveExtent,
+* which has already written a count covering it to the superblock, so a crash loses no page.
+*
+*/
+static RC setTotalNumPages(SM_FileHandle *fHandle, int totalNumPages)
+{
+	SM_FileInfo *fileInfo = (SM_FileInfo *)fHandle->mgmtInfo;
+	fileInfo->totalNumPages = totalNumPages;
+	fHandle->totalNumPages = totalNumPages;
+	return RC_OK;
 }
 
+/**
+*
+* This function returns the byte offset of a page inside its page file. The first page slot holds
+* the superblock, so page 0 starts one page in.
+*
+*/
+static off_t pageOffset(SM_FileInfo *fileInfo, int pageNum)
+{
+	return fileInfo->pageSize + (off_t)pageNum * fileInfo->pageStride;
+}
 
+/************************************************************
+ *                    CRC32C page checksums                 *
+ ************************************************************/
+
+static uint32_t crc32cTable[256];
+static uint32_t (*crc32cUpdate)(uint32_t crc, const uint8_t *data, size_t length);
+static pthread_once_t crc32cOnce = PTHREAD_ONCE_INIT;
 
 /**
 *
-* This function reads the current block associated with the fHandle. If the fHandle is
-* NULL it will throw an error.
+* This function computes the CRC32C of a buffer one byte at a time through a lookup table.
 *
 */
-RC readCurrentBlock(SM_FileHandle *fHandle, SM_PageHandle memPage)
+static uint32_t crc32cUpdateTable(uint32_t crc, const uint8_t *data, size_t length)
 {
-	if (fHandle){
-		RC currentBlockPosition = getBlockPos(fHandle);
-		readBlock(currentBlockPosition, fHandle, memPage);
-        printf("\nRead operation completed successfully for the current block!\n");
-		return RC_OK;
+	for (size_t i = 0; i < length; i++)
+	{
+		crc = crc32cTable[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
 	}
-    printf("\nRead operation can not be completed due to an Error!!!\n");
-    printf("\nERROR CODE : RC_FILE_HANDLE_NOT_INIT\n");
-	return RC_FILE_HANDLE_NOT_INIT;
+	return crc;
 }
 
+#if defined(__GNUC__) && defined(__x86_64__)
 /**
 *
-* This function reads the next block associated with the fHandle
+* This function computes the CRC32C of a buffer with the crc32 instruction of SSE4.2, eight bytes at a time.
 *
 */
-RC readNextBlock(SM_FileHandle *fHandle, SM_PageHandle memPage)
+__attribute__((target("sse4.2")))
+static uint32_t crc32cUpdateSSE42(uint32_t crc, const uint8_t *data, size_t length)
 {
-	if (fHandle){
-		RC nextBlockPosition = fHandle->curPagePos + 1;
-        printf("\nRead operation completed successfully for the previous block!\n");
-		return readBlock(nextBlockPosition, fHandle, memPage);
+	uint64_t crc64 = crc;
+	for (; length >= 8; data += 8, length -= 8)
+	{
+		uint64_t word;
+		memcpy(&word, data, sizeof(word));
+		crc64 = __builtin_ia32_crc32di(crc64, word);
 	}
-    printf("\nRead operation can not be completed due to an Error!!!\n");
-    printf("\nERROR CODE : RC_FILE_HANDLE_NOT_INIT\n");
-	return RC_FILE_HANDLE_NOT_INIT;
+	crc = (uint32_t)crc64;
+	for (; length > 0; data++, length--)
+	{
+		crc = __builtin_ia32_crc32qi(crc, *data);
+	}
+	return crc;
 }
+#endif
 
 /**
 *
-* This function reads the last block associated with the fHandle. It will calculate
-* the last position of the block by subtracting 1 from the total number of pages.
+* This function builds the lookup table and picks the hardware path if the CPU has SSE4.2.
 *
 */
-RC readLastBlock(SM_FileHandle *fHandle, SM_PageHandle memPage)
+static void initCrc32c(void)
 {
-
-	if (fHandle){
-		RC endBlockPosition = fHandle->totalNumPages - 1;
-        printf("\nRead operation completed successfully for the previous block!\n");
-		return readBlock(endBlockPosition, fHandle, memPage);
+	for (uint32_t i = 0; i < 256; i++)
+	{
+		uint32_t crc = i;
+		for (int bit = 0; bit < 8; bit++)
+			crc = (crc & 1) ? (crc >> 1) ^ SM_CRC32C_POLY : crc >> 1;
+		crc32cTable[i] = crc;
 	}
-    printf("\nRead operation can not be completed due to an Error!!!\n");
-    printf("\nERROR CODE : RC_FILE_NOT_FOUND\n");
-	return RC_FILE_NOT_FOUND;
+	crc32cUpdate = crc32cUpdateTable;
+#if defined(__GNUC__) && defined(__x86_64__)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("sse4.2"))
+		crc32cUpdate = crc32cUpdateSSE42;
+#endif
 }
 
 /**
 *
-* This function writes stream of data to the 'file'
+* This function returns the CRC32C of one page.
 *
 */
-RC writeBlock(int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage)
+static uint32_t pageChecksum(SM_FileInfo *fileInfo, const char *page)
 {
-	if (pageNum < 0 || pageNum > fHandle->totalNumPages) //If page number is not within a valid range it will throw an error
-        {
-        printf("\nWriting failed due to an error!!!\n");
-        printf("\nERROR CODE : RC_INVALID_PAGE_RANGE\n");
-		return RC_INVALID_PAGE_RANGE;
-        }
+	pthread_once(&crc32cOnce, initCrc32c);
+	return ~crc32cUpdate(~0U, (const uint8_t *)page, fileInfo->pageSize);
+}
 
-	if (file)
+/**
+*
+* This function checks a page read from disk against its trailer. A zero trailer belongs to a page that
+* was never written, such as the first page of a new file, which is fine as long as the page is empty.
+*
+*/
+static RC verifyPage(SM_FileInfo *fileInfo, const char *page, uint32_t trailer)
+{
+	if (trailer == pageChecksum(fileInfo, page))
 	{
-		bool isFailed = fseek(file, (PAGE_SIZE * pageNum), SEEK_SET);
-		if (!isFailed)
+		return RC_OK;
+	}
+	if (trailer == 0)
+	{
+		for (int i = 0; i < fileInfo->pageSize; i++)
 		{
-			fwrite(memPage, sizeof(char), PAGE_SIZE, file); //It will write the stream into 'file' from memePage
-			fHandle->curPagePos = pageNum;
-			fseek(file, 0, SEEK_END);
-			fHandle->totalNumPages = ftell(file) / PAGE_SIZE;
-            printf("\nWrite operation completed successfully for desired block!\n");
-			return RC_OK;
+			if (page[i] != '\0')
+				return RC_CHECKSUM_MISMATCH;
 		}
-        printf("\nWriting failed due to an error!!!\n");
-        printf("\nERROR CODE : RC_WRITE_FAILED\n");
-		return RC_WRITE_FAILED;
-
+		return RC_OK;
 	}
-    printf("\nRead operation can not be completed due to an Error!!!\n");
-    printf("\nERROR CODE : RC_FILE_NOT_OPENED\n");
-	return RC_FILE_NOT_OPENED;
+	return RC_CHECKSUM_MISMATCH;
 }
 
 /**
 *
-* This function writes stream of data to the 'file' into the current block
+* This function tells whether pageSize is a page size a page file can be created with.
 *
 */
-RC writeCurrentBlock(SM_FileHandle *fHandle, SM_PageHandle memPage)
+static bool isValidPageSize(int pageSize)
 {
-	RC currentBlockPosition = getBlockPos(fHandle); //For writing into current block it will get the current posotion of the block
-	return writeBlock(currentBlockPosition, fHandle, memPage); //It will just call writeBlock() with target position as current block position
+	return pageSize >= SM_MIN_PAGE_SIZE && pageSize <= SM_MAX_PAGE_SIZE && (pageSize & (pageSize - 1)) == 0;
 }
 
 /**
 *
-* This function appends an empty block after given block location
+* This function returns the number of pages the free-page bitmap of a file can track.
 *
 */
-RC appendEmptyBlock(SM_FileHandle *fHandle)
+static int freeMapCapacity(SM_FileInfo *fileInfo)
 {
-
-	if (file)
-	{
-		char *newBlock = (char *)calloc(PAGE_SIZE, sizeof(char)); //creating a new block and allocating the memory
-		fseek(file, 0, SEEK_END);
-		if (fwrite(newBlock, 1, PAGE_SIZE, file) == PAGE_SIZE)
-		{
-			(*fHandle).totalNumPages = ftell(file) / PAGE_SIZE; //updating the total number of pages
-			(*fHandle).curPagePos = fHandle->totalNumPages - 1; //setting the current page position
-            free(newBlock);
-            printf("\nAppended an empty block successfully!\n");
-			return RC_OK;
-		}
-        printf("\nAn empty block can not be appended due to an Error!!!\n");
-        printf("\nERROR CODE : RC_WRITE_FAILED\n");
-		return RC_WRITE_FAILED;	
-	}
-    printf("\nAn empty block can not be appended due to an Error!!!\n");
-    printf("\nERROR CODE : RC_FILE_NOT_FOUND\n");
-	return RC_FILE_NOT_FOUND; //it will throw an error if file is not accessible
-	
+	return (fileInfo->pageSize - (int)sizeof(SM_Superblock)) * 8;
 }
 
 /**
 *
-* This function ensures if total number of pages are greater than the required number of pages, else add more pages
+* This function makes sure the mapping of a memory-mapped file covers at least requiredSize bytes.
+* The mapping grows by doubling, with mremap where the platform has it. Growing may move the
+* mapping, which invalidates addresses handed out by getBlockAddress.
 *
 */
-RC ensureCapacity(int numberOfPages, SM_FileHandle *fHandle)
+static RC growMapping(SM_FileInfo *fileInfo, int fd, size_t requiredSize)
 {
-	int pageIndex = (*fHandle).totalNumPages; //getting the total number of pages as a current page index
-	if (numberOfPages > pageIndex) 
+	if (fileInfo->mapping != NULL && fileInfo->mappingSize >= requiredSize)
 	{
-		int morePage = numberOfPages - pageIndex;
-		while (morePage > 0) //it will append empty blocks until file reaches its required capacity
-		{
-			appendEmptyBlock(fHandle);
-			morePage--;
-		}
 		return RC_OK;
 	}
-    printf("\nOperation unsuccessful!!!\n");
-    printf("\nERROR CODE : RC_WRITE_FAILED\n");
-	return RC_WRITE_FAILED;
+
+	size_t newSize = fileInfo->mappingSize ? fileInfo->mappingSize : (size_t)pageOffset(fileInfo, SM_MIN_MAPPED_PAGES);
+	while (newSize < requiredSize)
+	{
+		newSize *= 2;
+	}
+
+	void *mapping;
+	if (fileInfo->mapping == NULL)
+	{
+		mapping = mmap(NULL, newSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	}
+	else
+	{
+#ifdef MREMAP_MAYMOVE
+		mapping = mremap(fileInfo->mapping, fileInfo->mappingSize, newSize, MREMAP_MAYMOVE);
+#else
+		munmap(fileInfo->mapping, fileInfo->mappingSize);
+		mapping = mmap(NULL, newSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+#endif
+	}
+
+	if (mapping == MAP_FAILED)
+	{
+		fileInfo->mapping = NULL;
+		fileInfo->mappingSize = 0;
+		return RC_MAP_FAILED;
+	}
+	fileInfo->mapping = mapping;
+	fileInfo->mappingSize = newSize;
+	return RC_OK;
+}
+
+/**
+*
+* This function makes sure at least numPages pages of the file exist on disk. The file grows by a whole
+* extent at a time, the larger of SM_MIN_EXTENT_SIZE and a tenth of the file, so appending pages one by
+* one does not cost one write each. Preallocated pages read as zeros. The superblock is written once per
+* extent, with the page count rounded up to the end of the extent, since opening the file drops everything
+* behind the count of the superblock and a crash would otherwise lose the pages added since the last close.
+*
+*/
+static RC reserveExtent(SM_FileInfo *fileInfo, int fd, int numPages)
+{
+	if (numPages <= fileInfo->allocatedPages)
+	{
+		return RC_OK;
+	}
+
+	int extentPages = SM_MIN_EXTENT_SIZE / fileInfo->pageStride;
+	if (extentPages < fileInfo->allocatedPages / 10)
+		extentPages = fileInfo->allocatedPages / 10;
+	int allocatedPages = fileInfo->allocatedPages + extentPages;
+	if (allocatedPages < numPages)
+		allocatedPages = numPages;
+
+	off_t start = pageOffset(fileInfo, fileInfo->allocatedPages);
+	off_t end = pageOffset(fileInfo, allocatedPages);
+	if (posix_fallocate(fd, start, end - start) != 0 && ftruncate(fd, end) != 0) //not every file system can preallocate
+	{
+		return RC_WRITE_FAILED;
+	}
+	if (writeSuperblock(fileInfo, fd, allocatedPages) != RC_OK)
+	{
+		return RC_WRITE_FAILED;
+	}
+	fileInfo->allocatedPages = allocatedPages;
+	return RC_OK;
+}
+
+/**
+*
+* This function tells whether the page buffers can be handed to the descriptor as they are, which
+* is always the case unless direct I/O needs them aligned to SM_IO_ALIGNMENT.
+*
+*/
+static bool isIOAligned(SM_FileInfo *fileInfo, int count, SM_PageHandle *memPages)
+{
+	if (!fileInfo->directIO)
+	{
+		return true;
+	}
+	for (int i = 0; i < count; i++)
+	{
+		if ((uintptr_t)memPages[i] % SM_IO_ALIGNMENT != 0)
+			return false;
+	}
+	return true;
+}
+
+static RC preadvPages(SM_FileInfo *fileInfo, int fd, int startPage, int count, SM_PageHandle *memPages);
+static RC pwritevPages(SM_FileInfo *fileInfo, int fd, int startPage, int count, SM_PageHandle *memPages);
+
+/**
+*
+* This function moves count pages of a direct I/O file one at a time through an aligned bounce
+* buffer, for callers whose page buffers are not aligned.
+*
+*/
+static RC bouncePages(SM_FileInfo *fileInfo, int fd, int startPage, int count, SM_PageHandle *memPages, bool isWrite)
+{
+	SM_PageHandle bounce;
+	RC rc = RC_OK;
+	if (posix_memalign((void **)&bounce, SM_IO_ALIGNMENT, fileInfo->pageSize) != 0)
+	{
+		return isWrite ? RC_WRITE_FAILED : RC_READ_NON_EXISTING_PAGE;
+	}
+	for (int i = 0; i < count && rc == RC_OK; i++)
+	{
+		if (isWrite)
+		{
+			memcpy(bounce, memPages[i], fileInfo->pageSize);
+			rc = pwritevPages(fileInfo, fd, startPage + i, 1, &bounce);
+		}
+		else
+		{
+			rc = preadvPages(fileInfo, fd, startPage + i, 1, &bounce);
+			memcpy(memPages[i], bounce, fileInfo->pageSize);
+		}
+	}
+	free(bounce);
+	return rc;
+}
+
+/**
+*
+* This function reads count consecutive pages of an open file, starting at startPage, into the
+* buffers of memPages with as few preadv calls as possible. Pages past the end of the file read as
+* zeros. The checksum trailers of a checksummed file are read along with the pages and verified.
+* It only reads immutable fields of the file entry, so the asynchronous I/O workers call it directly.
+*
+*/
+static RC preadvPages(SM_FileInfo *fileInfo, int fd, int startPage, int count, SM_PageHandle *memPages)
+{
+	struct iovec pageVectors[SM_MAX_VECTORED_PAGES];
+	uint32_t trailers[SM_MAX_VECTORED_PAGES / 2];
+	int vectorsPerPage = fileInfo->checksums ? 2 : 1;
+	if (!isIOAligned(fileInfo, count, memPages))
+	{
+		return bouncePages(fileInfo, fd, startPage, count, memPages, false);
+	}
+	while (count > 0)
+	{
+		int maxPages = SM_MAX_VECTORED_PAGES / vectorsPerPage;
+		int numPages = (count < maxPages) ? count : maxPages;
+		for (int i = 0; i < numPages; i++)
+		{
+			pageVectors[i * vectorsPerPage].iov_base = memPages[i];
+			pageVectors[i * vectorsPerPage].iov_len = fileInfo->pageSize;
+			if (fileInfo->checksums)
+			{
+				pageVectors[i * 2 + 1].iov_base = &trailers[i];
+				pageVectors[i * 2 + 1].iov_len = SM_CHECKSUM_SIZE;
+			}
+		}
+
+		ssize_t bytesRead = preadv(fd, pageVectors, numPages * vectorsPerPage, pageOffset(fileInfo, startPage));
+		if (bytesRead < 0)
+		{
+			return RC_READ_NON_EXISTING_PAGE;
+		}
+		for (int i = 0; i < numPages; i++) //a short read stops at the end of the file, the rest reads as zeros
+		{
+			ssize_t pageBytes = bytesRead - (ssize_t)i * fileInfo->pageStride;
+			if (pageBytes < fileInfo->pageStride)
+			{
+				if (pageBytes < fileInfo->pageSize)
+					memset(memPages[i] + (pageBytes > 0 ? pageBytes : 0), '\0', fileInfo->pageSize - (pageBytes > 0 ? pageBytes : 0));
+				if (fileInfo->checksums)
+					trailers[i] = 0;
+			}
+			if (fileInfo->checksums && verifyPage(fileInfo, memPages[i], trailers[i]) != RC_OK)
+			{
+				return RC_CHECKSUM_MISMATCH;
+			}
+		}
+
+		startPage += numPages;
+		memPages += numPages;
+		count -= numPages;
+	}
+	return RC_OK;
+}
+
+/**
+*
+* This function writes count consecutive pages of an open file, starting at startPage, from the
+* buffers of memPages with as few pwritev calls as possible. A checksummed file gets the checksum
+* trailer of every page written right behind it.
+*
+*/
+static RC pwritevPages(SM_FileInfo *fileInfo, int fd, int startPage, int count, SM_PageHandle *memPages)
+{
+	struct iovec pageVectors[SM_MAX_VECTORED_PAGES];
+	uint32_t trailers[SM_MAX_VECTORED_PAGES / 2];
+	int vectorsPerPage = fileInfo->checksums ? 2 : 1;
+	if (!isIOAligned(fileInfo, count, memPages))
+	{
+		return bouncePages(fileInfo, fd, startPage, count, memPages, true);
+	}
+	while (count > 0)
+	{
+		int maxPages = SM_MAX_VECTORED_PAGES / vectorsPerPage;
+		int numPages = (count < maxPages) ? count : maxPages;
+		for (int i = 0; i < numPages; i++)
+		{
+			pageVectors[i * vectorsPerPage].iov_base = memPages[i];
+			pageVectors[i * vectorsPerPage].iov_len = fileInfo->pageSize;
+			if (fileInfo->checksums)
+			{
+				trailers[i] = pageChecksum(fileInfo, memPages[i]);
+				pageVectors[i * 2 + 1].iov_base = &trailers[i];
+				pageVectors[i * 2 + 1].iov_len = SM_CHECKSUM_SIZE;
+			}
+		}
+
+		if (pwritev(fd, pageVectors, numPages * vectorsPerPage, pageOffset(fileInfo, startPage)) != (ssize_t)numPages * fileInfo->pageStride)
+		{
+			return RC_WRITE_FAILED;
+		}
+
+		startPage += numPages;
+		memPages += numPages;
+		count -= numPages;
+	}
+	return RC_OK;
+}
+
+/**
+*
+* This function reads count consecutive pages of an open file into memPages, from the mapping if the
+* file is mapped. Pages past the end of the file read as zeros.
+*
+*/
+static RC readPages(SM_FileInfo *fileInfo, int fd, int startPage, int count, SM_PageHandle *memPages)
+{
+	if (fileInfo->mapping != NULL)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			if (startPage + i < fileInfo->totalNumPages)
+			{
+				char *page = fileInfo->mapping + pageOffset(fileInfo, startPage + i);
+				memcpy(memPages[i], page, fileInfo->pageSize);
+				if (fileInfo->checksums)
+				{
+					uint32_t trailer;
+					memcpy(&trailer, page + fileInfo->pageSize, SM_CHECKSUM_SIZE);
+					if (verifyPage(fileInfo, memPages[i], trailer) != RC_OK)
+						return RC_CHECKSUM_MISMATCH;
+				}
+			}
+			else
+				memset(memPages[i], '\0', fileInfo->pageSize);
+		}
+		return RC_OK;
+	}
+
+	return preadvPages(fileInfo, fd, startPage, count, memPages);
+}
+
+/**
+*
+* This function writes count consecutive pages of an open file from memPages. A mapped file is first
+* grown by an extent when the pages reach past its end, and the pages are then copied into the mapping.
+*
+*/
+static RC writePages(SM_FileInfo *fileInfo, int fd, int startPage, int count, SM_PageHandle *memPages)
+{
+	if (fileInfo->mapping != NULL)
+	{
+		off_t requiredSize = pageOffset(fileInfo, startPage + count);
+		if (reserveExtent(fileInfo, fd, startPage + count) != RC_OK)
+		{
+			return RC_WRITE_FAILED;
+		}
+		if (growMapping(fileInfo, fd, requiredSize) != RC_OK)
+		{
+			return RC_WRITE_FAILED;
+		}
+		for (int i = 0; i < count; i++)
+		{
+			char *page = fileInfo->mapping + pageOffset(fileInfo, startPage + i);
+			memcpy(page, memPages[i], fileInfo->pageSize);
+			if (fileInfo->checksums)
+			{
+				uint32_t trailer = pageChecksum(fileInfo, memPages[i]);
+				memcpy(page + fileInfo->pageSize, &trailer, SM_CHECKSUM_SIZE);
+			}
+		}
+		return RC_OK;
+	}
+
+	return pwritevPages(fileInfo, fd, startPage, count, memPages);
+}
+
+// Here we are initializing the Storage manager
+void initStorageManager(void)
+{
+	printf("\n~~~~~~~~~~~~<STORAGE MANAGER LOADING>~~~~~~~~~~~~");
+}
+
+/**
+*
+*  This function creates a page file with the default PAGE_SIZE pages.
+*
+*/
+RC createPageFile(char *fName)
+{
+	return createPageFileWithFlags(fName, PAGE_SIZE, 0);
+}
+
+/**
+*
+*  This function creates a page file with pages of pageSize bytes and no flags.
+*
+*/
+RC createPageFileWithPageSize(char *fName, int pageSize)
+{
+	return createPageFileWithFlags(fName, pageSize, 0);
+}
+
+/**
+*
+* The body of createPageFileWithFlags, called with fileTableLock held.
+*
+*/
+static RC createPageFileWithFlagsLocked(char *fName, int pageSize, int flags)
+{
+	SM_FileInfo *cachedInfo = findFileInfo(fName);
+	if (cachedInfo != NULL)
+	{
+		if (cachedInfo->refCount > 0 || cachedInfo->ioInFlight > 0)
+		{
+			return RC_FILE_NOT_CLOSED;
+		}
+		releaseFileInfo(cachedInfo); //the cached page count would be stale after truncating
+	}
+
+	int fd = open(fName, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fd >= 0)
+	{
+		ssize_t fileSize = 2 * pageSize + ((flags & SM_FILE_CHECKSUMS) ? SM_CHECKSUM_SIZE : 0);
+		char *emptyFile = calloc(1, fileSize); //the superblock slot and one empty page, never written so its trailer stays zero
+		SM_Superblock *superblock = (SM_Superblock *)emptyFile;
+		superblock->magic = SM_FILE_MAGIC;
+		superblock->version = SM_FILE_VERSION;
+		superblock->pageSize = pageSize;
+		superblock->flags = flags;
+		superblock->numPages = 1;
+		for (int i = 0; i < SM_NUM_ROOT_PAGES; i++)
+			superblock->rootPages[i] = SM_NO_ROOT_PAGE;
+		ssize_t written = pwrite(fd, emptyFile, fileSize, 0);
+		free(emptyFile);
+		close(fd);
+		if (written != fileSize)
+		{
+			return RC_WRITE_FAILED;
+		}
+		printf("\ncreatePageFile() Executed successfully!\n");
+		return RC_OK;
+	}
+    printf("\nDesired file can not be accessed due to an Error!!!\n");
+    printf("\nERROR CODE : RC_FILE_NOT_FOUND\n");
+
+	return RC_FILE_NOT_FOUND;
+}
+
+/**
+*
+*  This function creates a page file with pages of pageSize bytes, a power of two between
+*  SM_MIN_PAGE_SIZE and SM_MAX_PAGE_SIZE. The file is created (or truncated) for reading and
+*  writing. The superblock recording the page size and flags and one page initialized with the
+*  null character are then written to the file using pwrite, and the file is closed. If the file
+*  can not be opened, the function returns the error code as RC_FILE_NOT_FOUND.
+*
+*  With SM_FILE_CHECKSUMS in flags every page is stored with a CRC32C trailer that is checked
+*  whenever the page is read, a page that does not match returns RC_CHECKSUM_MISMATCH.
+*
+*/
+RC createPageFileWithFlags(char *fName, int pageSize, int flags)
+{
+	if (!isValidPageSize(pageSize))
+	{
+		return RC_INVALID_PAGE_SIZE;
+	}
+
+	lockFileTable();
+	RC result = createPageFileWithFlagsLocked(fName, pageSize, flags);
+	unlockFileTable();
+	return result;
+}
+
+/**
+*
+* This function opens the desired Page File with the name as fName.
+*
+*/
+RC openPageFile(char *fName, SM_FileHandle *fHandle)
+{
+	return openPageFileWithMode(fName, fHandle, SM_MODE_DEFAULT);
+}
+
+/**
+*
+* The body of openPageFileWithMode, called with fileTableLock held.
+*
+*/
+static RC openPageFileWithModeLocked(char *fName, SM_FileHandle *fHandle, int mode)
+{
+	SM_FileInfo *fileInfo = findFileInfo(fName);
+	if (fileInfo == NULL)
+	{
+		int fd = open(fName, O_RDWR);
+		if (fd < 0)
+		{
+            printf("\nDesired file can not be accesses due to an Error!!!\n");
+            printf("\nERROR CODE : RC_FILE_NOT_FOUND\n");
+			return RC_FILE_NOT_FOUND;
+		}
+
+		SM_Superblock header;
+		void *superblock = NULL;
+		if (pread(fd, &header, sizeof(SM_Superblock), 0) != sizeof(SM_Superblock)
+				|| header.magic != SM_FILE_MAGIC || header.version != SM_FILE_VERSION || !isValidPageSize(header.pageSize)
+				|| posix_memalign(&superblock, SM_IO_ALIGNMENT, header.pageSize) != 0)
+		{
+			close(fd);
+			return RC_INVALID_PAGE_FILE;
+		}
+		if (pread(fd, superblock, header.pageSize, 0) != header.pageSize)
+		{
+			free(superblock);
+			close(fd);
+			return RC_INVALID_PAGE_FILE;
+		}
+
+		fileInfo = calloc(1, sizeof(SM_FileInfo));
+		fileInfo->fileName = strdup(fName);
+		fileInfo->fd = fd;
+		fileInfo->pageSize = header.pageSize;
+		fileInfo->checksums = (header.flags & SM_FILE_CHECKSUMS) != 0;
+		fileInfo->pageStride = header.pageSize + (fileInfo->checksums ? SM_CHECKSUM_SIZE : 0);
+		fileInfo->superblock = superblock;
+		fileInfo->totalNumPages = header.numPages;
+		fileInfo->allocatedPages = header.numPages;
+		linkFileInfoAtFront(fileInfo);
+		numOfOpenDescriptors++;
+
+		//pages behind the logical end are left over from preallocation, or were written before a crash, drop them
+		struct stat fileStat;
+		off_t logicalSize = pageOffset(fileInfo, fileInfo->totalNumPages);
+		if (fstat(fd, &fileStat) != 0 || (fileStat.st_size > logicalSize && ftruncate(fd, logicalSize) != 0))
+		{
+			releaseFileInfo(fileInfo);
+			return RC_INVALID_PAGE_FILE;
+		}
+		closeIdleDescriptors(fileInfo);
+	}
+
+	//pages of checksummed files are not aligned in the file, so those always go through the page cache
+	bool directIO = ((mode & SM_MODE_DIRECT) || (fileInfo->refCount > 0 && fileInfo->directIO)) && !fileInfo->checksums;
+	if (directIO != fileInfo->directIO)
+	{
+		fileInfo->directIO = directIO;
+		if (fileInfo->fd >= 0)
+			applyDirectIO(fileInfo, fileInfo->fd);
+	}
+
+	if ((mode & SM_MODE_MMAP) && fileInfo->mapping == NULL)
+	{
+		int fd = (fileInfo->fd >= 0) ? fileInfo->fd : open(fName, O_RDWR);
+		RC rc = (fd >= 0) ? growMapping(fileInfo, fd, pageOffset(fileInfo, fileInfo->totalNumPages)) : RC_FILE_NOT_FOUND;
+		if (fd != fileInfo->fd && fd >= 0)
+			close(fd);
+		if (rc != RC_OK)
+		{
+			if (fileInfo->refCount == 0)
+				releaseFileInfo(fileInfo);
+			return rc;
+		}
+	}
+	fileInfo->refCount++;
+
+	fHandle->fileName = fName;
+	fHandle->pageSize = fileInfo->pageSize;
+	fHandle->totalNumPages = fileInfo->totalNumPages;
+	fHandle->curPagePos = 0;
+	fHandle->mgmtInfo = fileInfo;
+
+	printf("\nopenPageFile() Executed successfully!\n");
+	return RC_OK;
+}
+
+/**
+*
+* This function opens the desired Page File with the name as fName in the given mode. With
+* SM_MODE_MMAP the file gets mapped into memory and all handles on it read and write pages
+* through the mapping, which suits read-mostly files that the kernel page cache can hold.
+* With SM_MODE_DIRECT page I/O bypasses the OS page cache, for callers such as the buffer
+* manager that cache pages themselves.
+*
+*/
+RC openPageFileWithMode(char *fName, SM_FileHandle *fHandle, int mode)
+{
+	lockFileTable();
+	RC result = openPageFileWithModeLocked(fName, fHandle, mode);
+	unlockFileTable();
+	return result;
+}
+
+/**
+*
+* The body of closePageFile, called with fileTableLock held.
+*
+*/
+static RC closePageFileLocked(SM_FileHandle *fHandle)
+{
+	if (fHandle == NULL || fHandle->mgmtInfo == NULL)
+	{
+		return RC_FILE_NOT_OPENED;
+	}
+	SM_FileInfo *fileInfo = (SM_FileInfo *)fHandle->mgmtInfo;
+	fileInfo->refCount--;
+	fHandle->mgmtInfo = NULL;
+	if (fileInfo->fd < 0)
+	{
+		return releaseFileInfo(fileInfo); //nothing left to cache
+	}
+	else if (fileInfo->refCount == 0)
+	{
+		return flushSuperblock(fileInfo);
+	}
+	return RC_OK;
+}
+
+/**
+*
+* This function Closes the page file associated with the SM_FileHandle fHandle. The descriptor stays
+* cached in the open-file table so that opening the file again is free.
+*
+*/
+RC closePageFile(SM_FileHandle *fHandle)
+{
+	lockFileTable();
+	RC result = closePageFileLocked(fHandle);
+	unlockFileTable();
+	return result;
+}
+
+/**
+*
+* The body of destroyPageFile, called with fileTableLock held.
+*
+*/
+static RC destroyPageFileLocked(char *fileName)
+{
+    SM_FileInfo *fileInfo = findFileInfo(fileName);
+    if(fileInfo == NULL || (fileInfo->refCount == 0 && fileInfo->ioInFlight == 0)){
+        if (fileInfo != NULL)
+            releaseFileInfo(fileInfo); //drop the cached descriptor of the file
+        return (remove(fileName) == 0) ? RC_OK : RC_FAILED_REMOVAL;
+    }
+    printf("File can only be destroyed if it is CLOSED");
+    return RC_FILE_NOT_CLOSED;
+	
+}
+
+/**
+*
+* This function distroys the page file associated with the file name fileName
+*
+*/
+RC destroyPageFile(char *fileName)
+{
+	lockFileTable();
+	RC result = destroyPageFileLocked(fileName);
+	unlockFileTable();
+	return result;
+}
+
+/**
+*
+* This function reads the block associated with the SM_FileHandle fHandle
+*
+*/
+RC readBlock(int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage)
+{
+    if(fHandle == NULL){
+        return RC_FILE_NOT_FOUND;
+    }
+
+    lockFileTable();
+    int fd = getFileDescriptor(fHandle); //also refreshes the page count of the handle
+	if (pageNum < 0 || fHandle->totalNumPages < pageNum) //If page number is out of range, it will throw an error
+	{
+        printf("\nThere is an Error in reading a Block!!!\n");
+        printf("\nERROR CODE : RC_READ_NON_EXISTING_PAGE\n");  
+        unlockFileTable();
+		return RC_READ_NON_EXISTING_PAGE;
+	}
+    if(fd >= 0){
+        SM_FileInfo *fileInfo = (SM_FileInfo *)fHandle->mgmtInfo;
+        bool unlocked = beginPageIO(fileInfo);
+        RC rc = readPages(fileInfo, fd, pageNum, 1, &memPage); //reading the page at its offset into memPage
+        endPageIO(fileInfo, unlocked);
+        if (rc != RC_OK)
+        {
+            unlockFileTable();
+            return rc;
+        }
+	    fHandle->curPagePos = pageNum; //updating the current page position to page number
+        unlockFileTable();
+        printf("\nRead operation completed successfully for the desired block!\n");
+        return RC_OK;
+    }
+    unlockFileTable();
+    return RC_FILE_NOT_OPENED;
+}
+
+/**
+*
+* This function will return the position of current block associated with the fHandle
+*
+*/
+int getBlockPos(SM_FileHandle *fHandle)
+{
+    printf("\nCurrent position of the block returned successfully!\n");
+	return fHandle?(fHandle->curPagePos):RC_FILE_NOT_FOUND;
+}
+
+/**
+*
+* This function returns the number of pages of an open page file. Another handle on the same file
+* may have grown it since fHandle was last used, so the count is taken from the shared file entry.
+*
+*/
+int getTotalNumPages(SM_FileHandle *fHandle)
+{
+	if (fHandle == NULL || fHandle->mgmtInfo == NULL)
+	{
+		return RC_FILE_NOT_FOUND;
+	}
+	lockFileTable();
+	int totalNumPages = ((SM_FileInfo *)fHandle->mgmtInfo)->totalNumPages;
+	unlockFileTable();
+	return totalNumPages;
+}
+
+/**
+*
+* This function reads the first block associated with the fHandle
+*
+*/
+RC readFirstBlock(SM_FileHandle *fHandle, SM_PageHandle memPage)
+{
+	return fHandle?readBlock(0, fHandle, memPage):RC_FILE_NOT_FOUND;
+}
+
+/**
+*
+* This function reads the previous block, position of the previous block can
+* not be less than zero. if it is less than zero it will throw an error
+*
+*/
+RC readPreviousBlock(SM_FileHandle *fHandle, SM_PageHandle memPage)
+{
+
+	if (fHandle){
+		RC previousBlockPosition;
+		previousBlockPosition = fHandle->curPagePos - 1;
+
+		if (previousBlockPosition < 0){
+            printf("\nPosition of the previous block can not be accessed due to an Error!!!\n");
+            printf("\nERROR CODE : RC_READ_NON_EXISTING_PAGE\n");
+			return RC_READ_NON_EXISTING_PAGE;
+		}
+        printf("\nRead operation completed successfully for the previous block!\n");
+		return readBlock(previousBlockPosition, fHandle, memPage);
+	}
+    printf("\nRead operation can not be completed due to an Error!!!\n");
+    printf("\nERROR CODE : RC_FILE_NOT_FOUND\n");
+	return RC_FILE_NOT_FOUND;
+}
+
+
+
+/**
+*
+* This function reads the current block associated with the fHandle. If the fHandle is
+* NULL it will throw an error.
+*
+*/
+RC readCurrentBlock(SM_FileHandle *fHandle, SM_PageHandle memPage)
+{
+	if (fHandle){
+		RC currentBlockPosition = getBlockPos(fHandle);
+		readBlock(currentBlockPosition, fHandle, memPage);
+        printf("\nRead operation completed successfully for the current block!\n");
+		return RC_OK;
+	}
+    printf("\nRead operation can not be completed due to an Error!!!\n");
+    printf("\nERROR CODE : RC_FILE_HANDLE_NOT_INIT\n");
+	return RC_FILE_HANDLE_NOT_INIT;
+}
+
+/**
+*
+* This function reads the next block associated with the fHandle
+*
+*/
+RC readNextBlock(SM_FileHandle *fHandle, SM_PageHandle memPage)
+{
+	if (fHandle){
+		RC nextBlockPosition = fHandle->curPagePos + 1;
+        printf("\nRead operation completed successfully for the previous block!\n");
+		return readBlock(nextBlockPosition, fHandle, memPage);
+	}
+    printf("\nRead operation can not be completed due to an Error!!!\n");
+    printf("\nERROR CODE : RC_FILE_HANDLE_NOT_INIT\n");
+	return RC_FILE_HANDLE_NOT_INIT;
+}
+
+/**
+*
+* This function reads the last block associated with the fHandle. It will calculate
+* the last position of the block by subtracting 1 from the total number of pages.
+*
+*/
+RC readLastBlock(SM_FileHandle *fHandle, SM_PageHandle memPage)
+{
+
+	if (fHandle){
+		RC endBlockPosition = fHandle->totalNumPages - 1;
+        printf("\nRead operation completed successfully for the previous block!\n");
+		return readBlock(endBlockPosition, fHandle, memPage);
+	}
+    printf("\nRead operation can not be completed due to an Error!!!\n");
+    printf("\nERROR CODE : RC_FILE_NOT_FOUND\n");
+	return RC_FILE_NOT_FOUND;
+}
+
+/**
+*
+* This function writes stream of data to the 'file'
+*
+*/
+RC writeBlock(int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage)
+{
+	lockFileTable();
+	int fd = getFileDescriptor(fHandle); //also refreshes the page count of the handle
+	if (fHandle == NULL || pageNum < 0 || pageNum > fHandle->totalNumPages) //If page number is not within a valid range it will throw an error
+        {
+        unlockFileTable();
+        printf("\nWriting failed due to an error!!!\n");
+        printf("\nERROR CODE : RC_INVALID_PAGE_RANGE\n");
+		return RC_INVALID_PAGE_RANGE;
+        }
+
+	if (fd >= 0)
+	{
+		SM_FileInfo *fileInfo = (SM_FileInfo *)fHandle->mgmtInfo;
+		bool isFailed = reserveExtent(fileInfo, fd, pageNum + 1) != RC_OK; //a write right after the last page needs room for it first
+		if (!isFailed)
+		{
+			bool unlocked = beginPageIO(fileInfo);
+			isFailed = writePages(fileInfo, fd, pageNum, 1, &memPage) != RC_OK; //It will write the stream into the file from memPage
+			endPageIO(fileInfo, unlocked);
+		}
+		if (!isFailed)
+		{
+			fHandle->curPagePos = pageNum;
+			if (pageNum >= fileInfo->totalNumPages)
+			{
+				isFailed = setTotalNumPages(fHandle, pageNum + 1) != RC_OK; //writing right after the last page grows the file by one page
+			}
+		}
+		if (!isFailed)
+		{
+			unlockFileTable();
+            printf("\nWrite operation completed successfully for desired block!\n");
+			return RC_OK;
+		}
+		unlockFileTable();
+        printf("\nWriting failed due to an error!!!\n");
+        printf("\nERROR CODE : RC_WRITE_FAILED\n");
+		return RC_WRITE_FAILED;
+
+	}
+	unlockFileTable();
+    printf("\nRead operation can not be completed due to an Error!!!\n");
+    printf("\nERROR CODE : RC_FILE_NOT_OPENED\n");
+	return RC_FILE_NOT_OPENED;
+}
+
+/**
+*
+* This function reads count consecutive blocks, starting at startPage, into the buffers of memPages.
+* The blocks are read with a single vectored read, instead of one read per block.
+*
+*/
+RC readBlocks(int startPage, int count, SM_FileHandle *fHandle, SM_PageHandle *memPages)
+{
+    if(fHandle == NULL){
+        return RC_FILE_NOT_FOUND;
+    }
+
+    lockFileTable();
+    int fd = getFileDescriptor(fHandle);
+	if (startPage < 0 || count <= 0 || fHandle->totalNumPages < startPage + count - 1) //every block has to be in range, like for readBlock
+	{
+		unlockFileTable();
+		return RC_READ_NON_EXISTING_PAGE;
+	}
+    RC rc = RC_FILE_NOT_OPENED;
+    if(fd >= 0){
+        SM_FileInfo *fileInfo = (SM_FileInfo *)fHandle->mgmtInfo;
+        bool unlocked = beginPageIO(fileInfo);
+        rc = readPages(fileInfo, fd, startPage, count, memPages);
+        endPageIO(fileInfo, unlocked);
+        if (rc == RC_OK)
+	        fHandle->curPagePos = startPage + count - 1;
+    }
+    unlockFileTable();
+    return rc;
+}
+
+/**
+*
+* This function writes count consecutive blocks, starting at startPage, from the buffers of memPages
+* with a single vectored write. The blocks may reach past the end of the file and grow it.
+*
+*/
+RC writeBlocks(int startPage, int count, SM_FileHandle *fHandle, SM_PageHandle *memPages)
+{
+	lockFileTable();
+	int fd = getFileDescriptor(fHandle); //also refreshes the page count of the handle
+	if (fHandle == NULL || startPage < 0 || count <= 0 || startPage > fHandle->totalNumPages)
+	{
+		unlockFileTable();
+		return RC_INVALID_PAGE_RANGE;
+	}
+	if (fd < 0)
+	{
+		unlockFileTable();
+		return RC_FILE_NOT_OPENED;
+	}
+
+	SM_FileInfo *fileInfo = (SM_FileInfo *)fHandle->mgmtInfo;
+	RC rc = reserveExtent(fileInfo, fd, startPage + count);
+	if (rc == RC_OK)
+	{
+		bool unlocked = beginPageIO(fileInfo);
+		rc = writePages(fileInfo, fd, startPage, count, memPages);
+		endPageIO(fileInfo, unlocked);
+	}
+	if (rc == RC_OK)
+	{
+		fHandle->curPagePos = startPage + count - 1;
+		if (startPage + count > fileInfo->totalNumPages)
+		{
+			rc = setTotalNumPages(fHandle, startPage + count);
+		}
+	}
+	unlockFileTable();
+	return (rc == RC_OK) ? RC_OK : RC_WRITE_FAILED;
+}
+
+/**
+*
+* This function writes stream of data to the 'file' into the current block
+*
+*/
+RC writeCurrentBlock(SM_FileHandle *fHandle, SM_PageHandle memPage)
+{
+	RC currentBlockPosition = getBlockPos(fHandle); //For writing into current block it will get the current posotion of the block
+	return writeBlock(currentBlockPosition, fHandle, memPage); //It will just call writeBlock() with target position as current block position
+}
+
+/**
+*
+* The body of appendEmptyBlock, called with fileTableLock held.
+*
+*/
+static RC appendEmptyBlockLocked(SM_FileHandle *fHandle)
+{
+
+	int fd = getFileDescriptor(fHandle);
+	if (fd >= 0)
+	{
+		SM_FileInfo *fileInfo = (SM_FileInfo *)fHandle->mgmtInfo;
+		//a preallocated page is already zero on disk, so the new block only has to be counted
+		if (reserveExtent(fileInfo, fd, fHandle->totalNumPages + 1) == RC_OK
+				&& (fileInfo->mapping == NULL || growMapping(fileInfo, fd, pageOffset(fileInfo, fHandle->totalNumPages + 1)) == RC_OK)
+				&& setTotalNumPages(fHandle, fHandle->totalNumPages + 1) == RC_OK) //updating the total number of pages
+		{
+			(*fHandle).curPagePos = fHandle->totalNumPages - 1; //setting the current page position
+            printf("\nAppended an empty block successfully!\n");
+			return RC_OK;
+		}
+        printf("\nAn empty block can not be appended due to an Error!!!\n");
+        printf("\nERROR CODE : RC_WRITE_FAILED\n");
+		return RC_WRITE_FAILED;	
+	}
+    printf("\nAn empty block can not be appended due to an Error!!!\n");
+    printf("\nERROR CODE : RC_FILE_NOT_FOUND\n");
+	return RC_FILE_NOT_FOUND; //it will throw an error if file is not accessible
+	
+}
+
+/**
+*
+* This function appends an empty block after given block location
+*
+*/
+RC appendEmptyBlock(SM_FileHandle *fHandle)
+{
+	lockFileTable();
+	RC result = appendEmptyBlockLocked(fHandle);
+	unlockFileTable();
+	return result;
+}
+
+/**
+*
+* The body of ensureCapacity, called with fileTableLock held.
+*
+*/
+static RC ensureCapacityLocked(int numberOfPages, SM_FileHandle *fHandle)
+{
+	int fd = getFileDescriptor(fHandle); //also refreshes the page count of the handle
+	int pageIndex = (*fHandle).totalNumPages; //getting the total number of pages as a current page index
+	if (fd >= 0 && numberOfPages > pageIndex) 
+	{
+		SM_FileInfo *fileInfo = (SM_FileInfo *)fHandle->mgmtInfo;
+		if (reserveExtent(fileInfo, fd, numberOfPages) != RC_OK
+				|| (fileInfo->mapping != NULL && growMapping(fileInfo, fd, pageOffset(fileInfo, numberOfPages)) != RC_OK)
+				|| setTotalNumPages(fHandle, numberOfPages) != RC_OK)
+		{
+			return RC_WRITE_FAILED;
+		}
+		fHandle->curPagePos = numberOfPages - 1;
+		return RC_OK;
+	}
+    printf("\nOperation unsuccessful!!!\n");
+    printf("\nERROR CODE : RC_WRITE_FAILED\n");
+	return RC_WRITE_FAILED;
+}
+
+/**
+*
+* This function ensures if total number of pages are greater than the required number of pages, else add more pages.
+* The missing pages are preallocated in one go and then counted, instead of being appended one at a time.
+*
+*/
+RC ensureCapacity(int numberOfPages, SM_FileHandle *fHandle)
+{
+	lockFileTable();
+	RC result = ensureCapacityLocked(numberOfPages, fHandle);
+	unlockFileTable();
+	return result;
+}
+
+/**
+*
+* The body of getBlockAddress, called with fileTableLock held.
+*
+*/
+static RC getBlockAddressLocked(int pageNum, SM_FileHandle *fHandle, SM_PageHandle *address)
+{
+	if (getFileDescriptor(fHandle) < 0)
+	{
+		return RC_FILE_NOT_OPENED;
+	}
+	SM_FileInfo *fileInfo = (SM_FileInfo *)fHandle->mgmtInfo;
+	if (fileInfo->mapping == NULL)
+	{
+		return RC_MAP_FAILED;
+	}
+	if (pageNum < 0 || pageNum >= fileInfo->totalNumPages)
+	{
+		return RC_READ_NON_EXISTING_PAGE;
+	}
+	*address = fileInfo->mapping + pageOffset(fileInfo, pageNum);
+	fHandle->curPagePos = pageNum;
+	return RC_OK;
+}
+
+/**
+*
+* This function hands out the address of a page inside the mapping of a file opened with SM_MODE_MMAP,
+* so the page can be read without copying it. The address stays valid until the file grows or the
+* last handle on it is closed.
+*
+*/
+RC getBlockAddress(int pageNum, SM_FileHandle *fHandle, SM_PageHandle *address)
+{
+	lockFileTable();
+	RC result = getBlockAddressLocked(pageNum, fHandle, address);
+	unlockFileTable();
+	return result;
+}
+
+/**
+*
+* The body of allocatePage, called with fileTableLock held.
+*
+*/
+static RC allocatePageLocked(SM_FileHandle *fHandle, int *pageNum)
+{
+	int fd = getFileDescriptor(fHandle);
+	if (fd < 0)
+	{
+		return RC_FILE_NOT_OPENED;
+	}
+	SM_FileInfo *fileInfo = (SM_FileInfo *)fHandle->mgmtInfo;
+	SM_Superblock *superblock = fileInfo->superblock;
+
+	int freePageNum = fileInfo->totalNumPages; //appending, unless a free page is found
+	if (superblock->numFreePages > 0)
+	{
+		int numBytes = (fileInfo->totalNumPages + 7) / 8;
+		for (int i = 0; i < numBytes; i++)
+		{
+			if (superblock->freeMap[i] != 0)
+			{
+				int bit = 0;
+				while (!(superblock->freeMap[i] & (1 << bit)))
+					bit++;
+				freePageNum = i * 8 + bit;
+				break;
+			}
+		}
+	}
+
+	if (freePageNum == fileInfo->totalNumPages)
+	{
+		RC rc = appendEmptyBlock(fHandle);
+		if (rc != RC_OK)
+		{
+			return rc;
+		}
+	}
+	else
+	{
+		char *emptyPage = (char *)calloc(fileInfo->pageSize, sizeof(char));
+		RC rc = writePages(fileInfo, fd, freePageNum, 1, &emptyPage);
+		free(emptyPage);
+		if (rc != RC_OK)
+		{
+			return rc;
+		}
+		superblock->freeMap[freePageNum / 8] &= ~(1 << (freePageNum % 8));
+		superblock->numFreePages--;
+		fileInfo->superblockDirty = true;
+	}
+	fHandle->curPagePos = freePageNum;
+	*pageNum = freePageNum;
+	return RC_OK;
+}
+
+/**
+*
+* This function hands out a page for new data and stores its number in pageNum. A page freed with
+* freePage is reused if there is one, otherwise a new page is appended to the file. Either way the
+* page is filled with the null character.
+*
+*/
+RC allocatePage(SM_FileHandle *fHandle, int *pageNum)
+{
+	lockFileTable();
+	RC result = allocatePageLocked(fHandle, pageNum);
+	unlockFileTable();
+	return result;
+}
+
+/**
+*
+* The body of freePage, called with fileTableLock held.
+*
+*/
+static RC freePageLocked(int pageNum, SM_FileHandle *fHandle)
+{
+	if (getFileDescriptor(fHandle) < 0)
+	{
+		return RC_FILE_NOT_OPENED;
+	}
+	SM_FileInfo *fileInfo = (SM_FileInfo *)fHandle->mgmtInfo;
+	SM_Superblock *superblock = fileInfo->superblock;
+	if (pageNum < 0 || pageNum >= fileInfo->totalNumPages)
+	{
+		return RC_READ_NON_EXISTING_PAGE;
+	}
+	if (pageNum >= freeMapCapacity(fileInfo) || (superblock->freeMap[pageNum / 8] & (1 << (pageNum % 8))))
+	{
+		return RC_FREE_PAGE_FAILED;
+	}
+	superblock->freeMap[pageNum / 8] |= 1 << (pageNum % 8);
+	superblock->numFreePages++;
+	fileInfo->superblockDirty = true;
+	return RC_OK;
+}
+
+/**
+*
+* This function marks a page as free, so that allocatePage can hand it out again instead of growing
+* the file. The content of the page is kept until it is reused. Freeing a page that is already free,
+* or one beyond what the free-page bitmap can track, returns RC_FREE_PAGE_FAILED.
+*
+*/
+RC freePage(int pageNum, SM_FileHandle *fHandle)
+{
+	lockFileTable();
+	RC result = freePageLocked(pageNum, fHandle);
+	unlockFileTable();
+	return result;
+}
+
+/**
+*
+* The body of getRootPage, called with fileTableLock held.
+*
+*/
+static int getRootPageLocked(int rootSlot, SM_FileHandle *fHandle)
+{
+	if (fHandle == NULL || fHandle->mgmtInfo == NULL || rootSlot < 0 || rootSlot >= SM_NUM_ROOT_PAGES)
+	{
+		return SM_NO_ROOT_PAGE;
+	}
+	return ((SM_FileInfo *)fHandle->mgmtInfo)->superblock->rootPages[rootSlot];
+}
+
+/**
+*
+* This function returns the page registered in root slot rootSlot of the superblock, or
+* SM_NO_ROOT_PAGE if the slot is unused. Higher layers keep the entry points of their structures
+* there, such as the metadata page of a table or the root of an index.
+*
+*/
+int getRootPage(int rootSlot, SM_FileHandle *fHandle)
+{
+	lockFileTable();
+	int result = getRootPageLocked(rootSlot, fHandle);
+	unlockFileTable();
+	return result;
+}
+
+/**
+*
+* The body of setRootPage, called with fileTableLock held.
+*
+*/
+static RC setRootPageLocked(int rootSlot, int pageNum, SM_FileHandle *fHandle)
+{
+	if (getFileDescriptor(fHandle) < 0) //the superblock is written back through the descriptor
+	{
+		return RC_FILE_NOT_OPENED;
+	}
+	SM_FileInfo *fileInfo = (SM_FileInfo *)fHandle->mgmtInfo;
+	if (rootSlot < 0 || rootSlot >= SM_NUM_ROOT_PAGES || pageNum < SM_NO_ROOT_PAGE || pageNum >= fileInfo->totalNumPages)
+	{
+		return RC_READ_NON_EXISTING_PAGE;
+	}
+	fileInfo->superblock->rootPages[rootSlot] = pageNum;
+	fileInfo->superblockDirty = true;
+	return RC_OK;
+}
+
+/**
+*
+* This function registers pageNum in root slot rootSlot of the superblock, SM_NO_ROOT_PAGE clears the slot.
+*
+*/
+RC setRootPage(int rootSlot, int pageNum, SM_FileHandle *fHandle)
+{
+	lockFileTable();
+	RC result = setRootPageLocked(rootSlot, pageNum, fHandle);
+	unlockFileTable();
+	return result;
+}
+
+/************************************************************
+ *            asynchronous page reads and writes            *
+ ************************************************************/
+
+/**
+*
+* One queued asynchronous read or write. Requests go through three lists: submitted by the caller
+* and not handed to the workers yet, queued for the workers, and completed but not reaped yet.
+* A request is only reaped by the thread that submitted it, its owner. A detached request is never
+* reaped, the worker that performs it runs its callback.
+*
+* grewFile is set for a write right after the last page. Such a page is counted when the write is
+* submitted, so further pages can be appended behind it, and uncounted again if the write fails.
+*
+*/
+typedef struct SM_IORequest
+{
+	pthread_t owner;
+	int pageNum;
+	bool isWrite;
+	bool detached;
+	bool grewFile;
+	int fd;
+	SM_FileInfo *fileInfo;
+	SM_PageHandle memPage;
+	SM_IOCallback callback;
+	void *context;
+	RC result;
+	struct SM_IORequest *next;
+} SM_IORequest;
+
+typedef struct SM_IORequestList
+{
+	SM_IORequest *front;
+	SM_IORequest *rear;
+} SM_IORequestList;
+
+static pthread_mutex_t ioLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t ioQueued = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t ioCompleted = PTHREAD_COND_INITIALIZER;
+static pthread_t ioThreads[SM_IO_THREADS];
+static bool ioThreadsStarted = false;
+static SM_IORequestList pendingRequests;
+static SM_IORequestList queuedRequests;
+static SM_IORequestList completedRequests;
+static int numOfRequestsInFlight = 0;
+static __thread int numOfOwnRequestsInFlight = 0;
+
+/**
+*
+* This function appends a request to the rear of a request list.
+*
+*/
+static void appendRequest(SM_IORequestList *list, SM_IORequest *request)
+{
+	request->next = NULL;
+	if (list->rear)
+		list->rear->next = request;
+	else
+		list->front = request;
+	list->rear = request;
+}
+
+/**
+*
+* This function takes the request at the front of a request list, NULL if the list is empty.
+*
+*/
+static SM_IORequest *takeRequest(SM_IORequestList *list)
+{
+	SM_IORequest *request = list->front;
+	if (request)
+	{
+		list->front = request->next;
+		if (list->front == NULL)
+			list->rear = NULL;
+	}
+	return request;
+}
+
+/**
+*
+* This function completes a detached request on the worker that performed it: the descriptor is
+* released, like reapCompletions does, then the callback runs and the request is freed. The entry
+* is not touched after the callback, which may let the file be closed and destroyed. Nothing is
+* locked while the callback runs.
+*
+*/
+static void finishDetachedRequest(SM_IORequest *request)
+{
+	lockFileTable();
+	request->fileInfo->ioInFlight--;
+	unlockFileTable();
+	if (request->callback)
+		request->callback(request->pageNum, request->result, request->context);
+	free(request);
+}
+
+/**
+*
+* This function uncounts the pages a failed batch of writes has added to the end of the file, so the
+* page count never covers a page that was not written. The batch is walked from its last page down,
+* and a page is only dropped while it is still the last page of the file, a page written meanwhile
+* behind it keeps the count, and the preallocated page in between reads as zeros.
+*
+*/
+static void uncountFailedWrites(SM_IORequest **batch, int numBatched)
+{
+	lockFileTable();
+	for (int i = numBatched - 1; i >= 0; i--)
+	{
+		SM_FileInfo *fileInfo = batch[i]->fileInfo;
+		if (batch[i]->grewFile && batch[i]->result != RC_OK && fileInfo->totalNumPages == batch[i]->pageNum + 1)
+			fileInfo->totalNumPages = batch[i]->pageNum; //handles pick the count up on their next access
+	}
+	unlockFileTable();
+}
+
+/**
+*
+* The body of an I/O worker thread. It takes the next queued request, together with the requests
+* queued right behind it for the following pages of the same file, performs them as one vectored
+* read or write without holding the lock, and moves them to the completed list. The callbacks of
+* detached requests are run right away instead, without the lock.
+*
+*/
+static void *ioWorker(void *unused)
+{
+	(void)unused;
+	pthread_mutex_lock(&ioLock);
+	while (true)
+	{
+		SM_IORequest *request = takeRequest(&queuedRequests);
+		if (request == NULL)
+		{
+			pthread_cond_wait(&ioQueued, &ioLock);
+			continue;
+		}
+
+		// requests queued right behind this one for the following pages of the same file become one vectored call
+		SM_IORequest *batch[SM_MAX_VECTORED_PAGES];
+		SM_PageHandle memPages[SM_MAX_VECTORED_PAGES];
+		int numBatched = 0;
+		batch[numBatched] = request;
+		memPages[numBatched++] = request->memPage;
+		while (numBatched < SM_MAX_VECTORED_PAGES && queuedRequests.front != NULL
+				&& queuedRequests.front->fd == request->fd
+				&& queuedRequests.front->isWrite == request->isWrite
+				&& queuedRequests.front->pageNum == request->pageNum + numBatched)
+		{
+			batch[numBatched] = takeRequest(&queuedRequests);
+			memPages[numBatched] = batch[numBatched]->memPage;
+			numBatched++;
+		}
+		pthread_mutex_unlock(&ioLock);
+
+		RC result = request->isWrite
+			? pwritevPages(request->fileInfo, request->fd, request->pageNum, numBatched, memPages)
+			: preadvPages(request->fileInfo, request->fd, request->pageNum, numBatched, memPages);
+
+		for (int i = 0; i < numBatched; i++)
+			batch[i]->result = result;
+		if (result == RC_CHECKSUM_MISMATCH && numBatched > 1) //only the pages failing their checksum fail
+		{
+			for (int i = 0; i < numBatched; i++)
+				batch[i]->result = preadvPages(request->fileInfo, request->fd, request->pageNum + i, 1, &memPages[i]);
+		}
+		if (request->isWrite && result != RC_OK)
+			uncountFailedWrites(batch, numBatched);
+
+		int numDetached = 0;
+		for (int i = 0; i < numBatched; i++)
+		{
+			if (batch[i]->detached)
+			{
+				finishDetachedRequest(batch[i]);
+				batch[i] = NULL;
+				numDetached++;
+			}
+		}
+
+		pthread_mutex_lock(&ioLock);
+		for (int i = 0; i < numBatched; i++)
+		{
+			if (batch[i] != NULL)
+				appendRequest(&completedRequests, batch[i]);
+		}
+		numOfRequestsInFlight -= numDetached;
+		pthread_cond_broadcast(&ioCompleted);
+	}
+	return NULL;
+}
+
+/**
+*
+* This function validates a request and adds it to the submitted list. Its descriptor is resolved
+* now, and the file entry keeps that descriptor open until the request has been reaped.
+*
+*/
+static RC submitRequest(int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage, bool isWrite, bool detached, SM_IOCallback callback, void *context)
+{
+	lockFileTable();
+	int fd = getFileDescriptor(fHandle);
+	if (fd < 0)
+	{
+		unlockFileTable();
+		return RC_FILE_NOT_OPENED;
+	}
+	if (pageNum < 0 || pageNum > fHandle->totalNumPages)
+	{
+		unlockFileTable();
+		return isWrite ? RC_INVALID_PAGE_RANGE : RC_READ_NON_EXISTING_PAGE;
+	}
+	SM_FileInfo *fileInfo = (SM_FileInfo *)fHandle->mgmtInfo;
+	//the page is counted right away, so its extent is reserved now and a mapping has to cover it before the handle reads it through the mapping
+	if (isWrite && pageNum == fHandle->totalNumPages
+			&& (reserveExtent(fileInfo, fd, pageNum + 1) != RC_OK
+				|| (fileInfo->mapping != NULL && growMapping(fileInfo, fd, pageOffset(fileInfo, pageNum + 1)) != RC_OK)))
+	{
+		unlockFileTable();
+		return RC_WRITE_FAILED;
+	}
+	bool grewFile = isWrite && pageNum == fHandle->totalNumPages;
+	if (grewFile && setTotalNumPages(fHandle, pageNum + 1) != RC_OK) //counted until the write fails, see uncountFailedWrites
+	{
+		unlockFileTable();
+		return RC_WRITE_FAILED;
+	}
+
+	SM_IORequest *request = malloc(sizeof(SM_IORequest));
+	request->owner = pthread_self();
+	request->pageNum = pageNum;
+	request->isWrite = isWrite;
+	request->detached = detached;
+	request->grewFile = grewFile;
+	request->fd = fd;
+	request->fileInfo = fileInfo;
+	request->memPage = memPage;
+	request->callback = callback;
+	request->context = context;
+	request->result = RC_OK;
+	request->fileInfo->ioInFlight++;
+
+	fHandle->curPagePos = pageNum;
+	unlockFileTable();
+
+	pthread_mutex_lock(&ioLock);
+	if (!ioThreadsStarted)
+	{
+		for (int i = 0; i < SM_IO_THREADS; i++)
+		{
+			pthread_create(&ioThreads[i], NULL, ioWorker, NULL);
+			pthread_detach(ioThreads[i]);
+		}
+		ioThreadsStarted = true;
+	}
+	appendRequest(&pendingRequests, request);
+	numOfRequestsInFlight++;
+	pthread_mutex_unlock(&ioLock);
+	if (!detached)
+		numOfOwnRequestsInFlight++;
+	return RC_OK;
+}
+
+/**
+*
+* This function queues an asynchronous read of page pageNum into memPage. The read is handed to the
+* I/O workers together with the other submitted requests on the next reapCompletions call, and
+* callback runs from that call once the read has finished. memPage must stay valid until then.
+*
+*/
+RC submitRead(int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage, SM_IOCallback callback, void *context)
+{
+	return submitRequest(pageNum, fHandle, memPage, false, false, callback, context);
+}
+
+/**
+*
+* This function queues an asynchronous read like submitRead, but the read is detached from the
+* calling thread: callback runs on the I/O worker that performed the read, as soon as it has
+* finished, and reapCompletions never returns it. The read is handed to the workers on the next
+* reapCompletions call of any thread, reapCompletions(0) does so without waiting. callback must
+* not wait for asynchronous I/O itself.
+*
+*/
+RC submitDetachedRead(int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage, SM_IOCallback callback, void *context)
+{
+	return submitRequest(pageNum, fHandle, memPage, false, true, callback, context);
+}
+
+/**
+*
+* This function queues an asynchronous write of memPage to page pageNum, like submitRead.
+*
+*/
+RC submitWrite(int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage, SM_IOCallback callback, void *context)
+{
+	return submitRequest(pageNum, fHandle, memPage, true, false, callback, context);
+}
+
+/**
+*
+* This function counts the completed requests of the calling thread, with ioLock held.
+*
+*/
+static int countOwnCompletions(pthread_t self)
+{
+	int numCompleted = 0;
+	for (SM_IORequest *request = completedRequests.front; request != NULL; request = request->next)
+	{
+		if (pthread_equal(request->owner, self))
+			numCompleted++;
+	}
+	return numCompleted;
+}
+
+/**
+*
+* This function unlinks the completed requests of the calling thread from the completed list, with
+* ioLock held, and returns them as a list in completion order.
+*
+*/
+static SM_IORequest *takeOwnCompletions(pthread_t self)
+{
+	SM_IORequestList own = { NULL, NULL };
+	SM_IORequestList others = { NULL, NULL };
+	SM_IORequest *request;
+	while ((request = takeRequest(&completedRequests)) != NULL)
+	{
+		appendRequest(pthread_equal(request->owner, self) ? &own : &others, request);
+	}
+	completedRequests = others;
+	return own.front;
+}
+
+/**
+*
+* This function moves all submitted requests to the queue of the I/O workers and wakes them up once
+* for the whole batch. It is called with ioLock held.
+*
+*/
+static void queuePendingRequests(void)
+{
+	if (pendingRequests.front)
+	{
+		if (queuedRequests.rear)
+			queuedRequests.rear->next = pendingRequests.front;
+		else
+			queuedRequests.front = pendingRequests.front;
+		queuedRequests.rear = pendingRequests.rear;
+		pendingRequests.front = pendingRequests.rear = NULL;
+		pthread_cond_broadcast(&ioQueued); //one wake-up for the whole batch
+	}
+}
+
+/**
+*
+* This function hands all submitted requests to the I/O workers as one batch, without waiting for
+* them and without reaping any completed request. Callers that only submit detached requests use it,
+* so the requests the calling thread still has to reap keep waiting for its next reapCompletions.
+*
+*/
+void dispatchSubmittedIO(void)
+{
+	pthread_mutex_lock(&ioLock);
+	queuePendingRequests();
+	pthread_mutex_unlock(&ioLock);
+}
+
+/**
+*
+* This function hands all submitted requests to the I/O workers as one batch, waits until at least
+* minCompletions requests of the calling thread (or every one it has in flight) have completed, and
+* then runs the callbacks of all its completed requests. It returns the number of requests reaped.
+* Requests submitted by other threads are left for them to reap, so several threads can use the
+* asynchronous I/O at the same time.
+*
+*/
+int reapCompletions(int minCompletions)
+{
+	int numReaped = 0;
+	SM_IORequest *request;
+	pthread_t self = pthread_self();
+
+	pthread_mutex_lock(&ioLock);
+	queuePendingRequests();
+
+	if (minCompletions > numOfOwnRequestsInFlight)
+	{
+		minCompletions = numOfOwnRequestsInFlight;
+	}
+	while (countOwnCompletions(self) < minCompletions)
+	{
+		pthread_cond_wait(&ioCompleted, &ioLock);
+	}
+	SM_IORequest *completed = takeOwnCompletions(self);
+	pthread_mutex_unlock(&ioLock);
+
+	while (completed != NULL)
+	{
+		request = completed;
+		completed = completed->next;
+
+		lockFileTable();
+		request->fileInfo->ioInFlight--;
+		unlockFileTable();
+		if (request->callback)
+			request->callback(request->pageNum, request->result, request->context);
+		free(request);
+		numReaped++;
+	}
+
+	pthread_mutex_lock(&ioLock);
+	numOfRequestsInFlight -= numReaped;
+	pthread_mutex_unlock(&ioLock);
+	numOfOwnRequestsInFlight -= numReaped;
+	return numReaped;
+}
+
+/**
+*
+* This function returns the number of asynchronous requests submitted and not reaped yet.
+*
+*/
+int getNumPendingIO(void)
+{
+	pthread_mutex_lock(&ioLock);
+	int numPending = numOfRequestsInFlight;
+	pthread_mutex_unlock(&ioLock);
+	return numPending;
 }
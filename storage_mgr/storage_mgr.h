@@ -8,6 +8,7 @@
  ************************************************************/
 typedef struct SM_FileHandle {
 	char *fileName;
+	int pageSize;
 	int totalNumPages;
 	int curPagePos;
 	void *mgmtInfo;
@@ -15,29 +16,72 @@ typedef struct SM_FileHandle {
 
 typedef char* SM_PageHandle;
 
+/* completion callback of an asynchronous page read or write */
+typedef void (*SM_IOCallback) (int pageNum, RC result, void *context);
+
+/* open modes for openPageFileWithMode, they can be combined with | */
+#define SM_MODE_DEFAULT 0
+#define SM_MODE_MMAP 1
+#define SM_MODE_DIRECT 2
+
+/* flags a page file can be created with */
+#define SM_FILE_CHECKSUMS 1 // store a CRC32C with every page and verify it on read, SM_MODE_DIRECT is ignored for such files
+
+/* page sizes a page file can be created with, PAGE_SIZE is the default */
+#define SM_MIN_PAGE_SIZE 4096
+#define SM_MAX_PAGE_SIZE 65536
+
+/* root page slots in the superblock of a page file, for higher layers to find their structures */
+#define SM_NUM_ROOT_PAGES 8
+#define SM_NO_ROOT_PAGE -1
+
+/* page buffers used with SM_MODE_DIRECT should be aligned to this many bytes */
+#define SM_IO_ALIGNMENT 4096
+
 /************************************************************
  *                    interface                             *
  ************************************************************/
 /* manipulating page files */
 extern void initStorageManager (void);
 extern RC createPageFile (char *fileName);
+extern RC createPageFileWithPageSize (char *fileName, int pageSize);
+extern RC createPageFileWithFlags (char *fileName, int pageSize, int flags);
 extern RC openPageFile (char *fileName, SM_FileHandle *fHandle);
+extern RC openPageFileWithMode (char *fileName, SM_FileHandle *fHandle, int mode);
 extern RC closePageFile (SM_FileHandle *fHandle);
 extern RC destroyPageFile (char *fileName);
 
 /* reading blocks from disc */
 extern RC readBlock (int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage);
 extern int getBlockPos (SM_FileHandle *fHandle);
+extern int getTotalNumPages (SM_FileHandle *fHandle);
 extern RC readFirstBlock (SM_FileHandle *fHandle, SM_PageHandle memPage);
 extern RC readPreviousBlock (SM_FileHandle *fHandle, SM_PageHandle memPage);
 extern RC readCurrentBlock (SM_FileHandle *fHandle, SM_PageHandle memPage);
 extern RC readNextBlock (SM_FileHandle *fHandle, SM_PageHandle memPage);
 extern RC readLastBlock (SM_FileHandle *fHandle, SM_PageHandle memPage);
+extern RC getBlockAddress (int pageNum, SM_FileHandle *fHandle, SM_PageHandle *address);
+extern RC readBlocks (int startPage, int count, SM_FileHandle *fHandle, SM_PageHandle *memPages);
 
 /* writing blocks to a page file */
 extern RC writeBlock (int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage);
 extern RC writeCurrentBlock (SM_FileHandle *fHandle, SM_PageHandle memPage);
+extern RC writeBlocks (int startPage, int count, SM_FileHandle *fHandle, SM_PageHandle *memPages);
 extern RC appendEmptyBlock (SM_FileHandle *fHandle);
 extern RC ensureCapacity (int numberOfPages, SM_FileHandle *fHandle);
 
+/* allocating pages and registering root pages */
+extern RC allocatePage (SM_FileHandle *fHandle, int *pageNum);
+extern RC freePage (int pageNum, SM_FileHandle *fHandle);
+extern int getRootPage (int rootSlot, SM_FileHandle *fHandle);
+extern RC setRootPage (int rootSlot, int pageNum, SM_FileHandle *fHandle);
+
+/* asynchronous page I/O */
+extern RC submitRead (int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage, SM_IOCallback callback, void *context);
+extern RC submitWrite (int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage, SM_IOCallback callback, void *context);
+extern RC submitDetachedRead (int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage, SM_IOCallback callback, void *context);
+extern void dispatchSubmittedIO (void);
+extern int reapCompletions (int minCompletions);
+extern int getNumPendingIO (void);
+
 #endif
@@ -1,7 +1,13 @@
+// pread is hidden by a strict -std=c99 build
+#define _XOPEN_SOURCE 700
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <time.h>
 
 #include "storage_mgr.h"
 #include "dberror.h"
@@ -12,10 +18,19 @@ char *testName;
 
 /* test output files */
 #define TESTPF "test_pagefile.bin"
+#define TESTPF2 "test_pagefile2.bin"
 
 /* prototypes for test functions */
 static void testCreateOpenClose(void);
 static void testSinglePageContent(void);
+static void testMultipleOpenFiles(void);
+static void testMappedPageFile(void);
+static void testAsyncReadWrite(void);
+static void testMultiBlockReadWrite(void);
+static void testPageSize(void);
+static void testFreePages(void);
+static void testChecksums(void);
+static void testPreallocation(void);
 
 /* main function running all tests */
 int
@@ -27,6 +42,14 @@ main (void)
 
   testCreateOpenClose();
   testSinglePageContent();
+  testMultipleOpenFiles();
+  testMappedPageFile();
+  testAsyncReadWrite();
+  testMultiBlockReadWrite();
+  testPageSize();
+  testFreePages();
+  testChecksums();
+  testPreallocation();
 
   return 0;
 }
@@ -103,3 +126,455 @@ testSinglePageContent(void)
   
   TEST_DONE();
 }
+
+/* Open two page files at once and check that their I/O does not interfere */
+void
+testMultipleOpenFiles(void)
+{
+  SM_FileHandle fh1, fh2;
+  SM_PageHandle ph;
+
+  testName = "test multiple open files";
+
+  ph = (SM_PageHandle) malloc(PAGE_SIZE);
+
+  TEST_CHECK(createPageFile (TESTPF));
+  TEST_CHECK(createPageFile (TESTPF2));
+  TEST_CHECK(openPageFile (TESTPF, &fh1));
+  TEST_CHECK(openPageFile (TESTPF2, &fh2));
+
+  // write a different page into each file
+  memset(ph, 'a', PAGE_SIZE);
+  TEST_CHECK(writeBlock (0, &fh1, ph));
+  memset(ph, 'b', PAGE_SIZE);
+  TEST_CHECK(writeBlock (0, &fh2, ph));
+  TEST_CHECK(appendEmptyBlock (&fh2));
+  ASSERT_TRUE((fh1.totalNumPages == 1), "first file still has 1 page");
+  ASSERT_TRUE((fh2.totalNumPages == 2), "second file grew to 2 pages");
+
+  // read them back through the other handle order
+  TEST_CHECK(readFirstBlock (&fh1, ph));
+  ASSERT_TRUE((ph[0] == 'a' && ph[PAGE_SIZE - 1] == 'a'), "first file kept its own content");
+  TEST_CHECK(readFirstBlock (&fh2, ph));
+  ASSERT_TRUE((ph[0] == 'b' && ph[PAGE_SIZE - 1] == 'b'), "second file kept its own content");
+
+  // a file that is still open can not be destroyed, a closed one can
+  TEST_CHECK(closePageFile (&fh1));
+  ASSERT_TRUE((destroyPageFile(TESTPF2) != RC_OK), "destroying an open file should return an error.");
+  TEST_CHECK(destroyPageFile (TESTPF));
+
+  // re-opening the second file sees the page count written through the first handle
+  TEST_CHECK(openPageFile (TESTPF2, &fh1));
+  ASSERT_TRUE((fh1.totalNumPages == 2), "second handle on the same file sees 2 pages");
+
+  // a page appended through one handle is counted through the other
+  TEST_CHECK(appendEmptyBlock (&fh1));
+  ASSERT_TRUE((getTotalNumPages(&fh2) == 3), "page count of the file covers pages appended through another handle");
+  TEST_CHECK(closePageFile (&fh1));
+  TEST_CHECK(closePageFile (&fh2));
+  TEST_CHECK(destroyPageFile (TESTPF2));
+
+  free(ph);
+
+  TEST_DONE();
+}
+
+/* Write and read pages of a memory-mapped page file */
+void
+testMappedPageFile(void)
+{
+  SM_FileHandle fh;
+  SM_PageHandle ph, mapped;
+  int i;
+
+  testName = "test memory-mapped page file";
+
+  ph = (SM_PageHandle) malloc(PAGE_SIZE);
+
+  TEST_CHECK(createPageFile (TESTPF));
+  TEST_CHECK(openPageFileWithMode (TESTPF, &fh, SM_MODE_MMAP));
+
+  // grow the file well past the initial mapping and stamp every page
+  for (i = 0; i < 300; i++)
+    {
+      memset(ph, 'A' + (i % 26), PAGE_SIZE);
+      TEST_CHECK(writeBlock (i, &fh, ph));
+    }
+  ASSERT_TRUE((fh.totalNumPages == 300), "mapped file grew to 300 pages");
+
+  TEST_CHECK(readBlock (299, &fh, ph));
+  ASSERT_TRUE((ph[0] == 'A' + (299 % 26)), "last page read back through the mapping");
+
+  // the zero-copy address sees the same bytes
+  TEST_CHECK(getBlockAddress (27, &fh, &mapped));
+  ASSERT_TRUE((mapped[PAGE_SIZE - 1] == 'B'), "page address points into the mapping");
+  TEST_CHECK(closePageFile (&fh));
+
+  // a normal handle sees what was written through the mapping
+  TEST_CHECK(openPageFile (TESTPF, &fh));
+  ASSERT_TRUE((fh.totalNumPages == 300), "page count survives re-opening");
+  TEST_CHECK(readBlock (52, &fh, ph));
+  ASSERT_TRUE((ph[PAGE_SIZE / 2] == 'A'), "page written through the mapping is on disk");
+  TEST_CHECK(closePageFile (&fh));
+  TEST_CHECK(destroyPageFile (TESTPF));
+
+  free(ph);
+
+  TEST_DONE();
+}
+
+/* completion callback of the asynchronous test, counts the successful requests */
+static void
+countCompletion(int pageNum, RC result, void *context)
+{
+  if (result == RC_OK)
+    (*(int *) context)++;
+}
+
+/* completion callback of detached reads, which runs on the I/O workers */
+static void
+countDetachedCompletion(int pageNum, RC result, void *context)
+{
+  if (result == RC_OK)
+    __atomic_add_fetch((int *) context, 1, __ATOMIC_RELAXED);
+}
+
+/* Write and read back a batch of pages through the asynchronous interface */
+void
+testAsyncReadWrite(void)
+{
+  SM_FileHandle fh;
+  SM_PageHandle pages[16];
+  char *mappedPages;
+  int numCompleted = 0;
+  int numReaped = 0;
+  int i;
+  struct timespec pause = { 0, 1000000 };
+
+  testName = "test asynchronous reads and writes";
+
+  TEST_CHECK(createPageFile (TESTPF));
+  TEST_CHECK(openPageFile (TESTPF, &fh));
+
+  // submit a batch of writes that also grows the file
+  for (i = 0; i < 16; i++)
+    {
+      pages[i] = (SM_PageHandle) malloc(PAGE_SIZE);
+      memset(pages[i], 'a' + i, PAGE_SIZE);
+      TEST_CHECK(submitWrite (i, &fh, pages[i], countCompletion, &numCompleted));
+    }
+  ASSERT_TRUE((fh.totalNumPages == 16), "page count covers the submitted writes");
+  ASSERT_TRUE((reapCompletions(16) == 16), "all writes were reaped");
+  ASSERT_TRUE((numCompleted == 16), "all writes completed successfully");
+
+  // read the pages back in reverse order
+  numCompleted = 0;
+  for (i = 0; i < 16; i++)
+    {
+      memset(pages[i], 0, PAGE_SIZE);
+      TEST_CHECK(submitRead (15 - i, &fh, pages[i], countCompletion, &numCompleted));
+    }
+  ASSERT_ERROR(submitRead (17, &fh, pages[0], countCompletion, &numCompleted), "reading past the end should return an error");
+  while (getNumPendingIO() > 0)
+    reapCompletions(1);
+  ASSERT_TRUE((numCompleted == 16), "all reads completed successfully");
+  for (i = 0; i < 16; i++)
+    ASSERT_TRUE((pages[i][PAGE_SIZE - 1] == 'a' + 15 - i), "page read asynchronously has the expected content");
+
+  // detached reads complete on their own, nobody reaps them, and dispatching them leaves the other requests of the thread unreaped
+  numCompleted = 0;
+  numReaped = 0;
+  for (i = 0; i < 16; i++)
+    {
+      memset(pages[i], 0, PAGE_SIZE);
+      if (i < 15)
+        {
+          TEST_CHECK(submitDetachedRead (i, &fh, pages[i], countDetachedCompletion, &numCompleted));
+        }
+      else
+        {
+          TEST_CHECK(submitRead (i, &fh, pages[i], countCompletion, &numReaped));
+        }
+    }
+  dispatchSubmittedIO();
+  while (getNumPendingIO() > 1)
+    nanosleep(&pause, NULL);
+  ASSERT_TRUE((__atomic_load_n(&numCompleted, __ATOMIC_RELAXED) == 15), "all detached reads completed successfully");
+  ASSERT_TRUE((numReaped == 0), "dispatching runs no callback of the calling thread");
+  ASSERT_TRUE((reapCompletions(16) == 1), "detached reads are not reaped");
+  ASSERT_TRUE((numReaped == 1), "the read of the calling thread is reaped by its next reap");
+  for (i = 0; i < 16; i++)
+    ASSERT_TRUE((pages[i][0] == 'a' + i), "page read by a detached read has the expected content");
+
+  TEST_CHECK(closePageFile (&fh));
+  TEST_CHECK(destroyPageFile (TESTPF));
+
+  // asynchronous writes that append to a mapped file grow its mapping, so the pages can be read through it
+  TEST_CHECK(createPageFile (TESTPF));
+  TEST_CHECK(openPageFileWithMode (TESTPF, &fh, SM_MODE_MMAP));
+  mappedPages = (char *) malloc(300 * PAGE_SIZE);
+  numCompleted = 0;
+  for (i = 0; i < 300; i++)
+    {
+      memset(mappedPages + i * PAGE_SIZE, 'A' + (i % 26), PAGE_SIZE);
+      TEST_CHECK(submitWrite (i, &fh, mappedPages + i * PAGE_SIZE, countCompletion, &numCompleted));
+    }
+  while (getNumPendingIO() > 0)
+    reapCompletions(1);
+  ASSERT_TRUE((numCompleted == 300), "all appending writes completed successfully");
+  TEST_CHECK(readBlock (299, &fh, pages[0]));
+  ASSERT_TRUE((pages[0][0] == 'A' + (299 % 26)), "page appended asynchronously read back through the mapping");
+  TEST_CHECK(closePageFile (&fh));
+  TEST_CHECK(destroyPageFile (TESTPF));
+  free(mappedPages);
+
+  for (i = 0; i < 16; i++)
+    free(pages[i]);
+
+  TEST_DONE();
+}
+
+/* Write and read runs of pages with the multi-block interface */
+void
+testMultiBlockReadWrite(void)
+{
+  SM_FileHandle fh;
+  SM_PageHandle pages[8];
+  int i;
+
+  testName = "test multi-block reads and writes";
+
+  for (i = 0; i < 8; i++)
+    {
+      pages[i] = (SM_PageHandle) malloc(PAGE_SIZE);
+      memset(pages[i], '0' + i, PAGE_SIZE);
+    }
+
+  TEST_CHECK(createPageFile (TESTPF));
+  TEST_CHECK(openPageFile (TESTPF, &fh));
+
+  // write 8 pages at once, growing the file from 1 to 9 pages
+  TEST_CHECK(writeBlocks (1, 8, &fh, pages));
+  ASSERT_TRUE((fh.totalNumPages == 9), "file grew to 9 pages");
+  ASSERT_ERROR(writeBlocks (11, 2, &fh, pages), "writing behind the end of the file should return an error");
+
+  // read them back shifted by one page, the first page is still empty
+  for (i = 0; i < 8; i++)
+    memset(pages[i], 'x', PAGE_SIZE);
+  TEST_CHECK(readBlocks (0, 8, &fh, pages));
+  ASSERT_TRUE((pages[0][0] == 0), "first page is still empty");
+  for (i = 1; i < 8; i++)
+    ASSERT_TRUE((pages[i][PAGE_SIZE - 1] == '0' + i - 1), "page read in a run has the expected content");
+  ASSERT_TRUE((getBlockPos(&fh) == 7), "position is the last block read");
+
+  TEST_CHECK(closePageFile (&fh));
+  TEST_CHECK(destroyPageFile (TESTPF));
+
+  for (i = 0; i < 8; i++)
+    free(pages[i]);
+
+  TEST_DONE();
+}
+
+/* Try page files with a page size other than PAGE_SIZE */
+void
+testPageSize(void)
+{
+  SM_FileHandle fh;
+  SM_PageHandle ph;
+  int pageSize = 4 * PAGE_SIZE;
+  int i;
+
+  testName = "test page files with a custom page size";
+
+  ASSERT_TRUE((createPageFileWithPageSize (TESTPF, 3000) == RC_INVALID_PAGE_SIZE), "page size must be a power of two");
+  ASSERT_TRUE((createPageFileWithPageSize (TESTPF, 2 * SM_MAX_PAGE_SIZE) == RC_INVALID_PAGE_SIZE), "page size must not be too large");
+
+  TEST_CHECK(createPageFileWithPageSize (TESTPF, pageSize));
+  TEST_CHECK(openPageFile (TESTPF, &fh));
+  ASSERT_TRUE((fh.pageSize == pageSize), "page size is read back from the file header");
+  ASSERT_TRUE((fh.totalNumPages == 1), "expect 1 page in new file");
+
+  ph = (SM_PageHandle) malloc(pageSize);
+  for (i = 0; i < pageSize; i++)
+    ph[i] = (i % 10) + '0';
+  TEST_CHECK(writeBlock (1, &fh, ph));
+  TEST_CHECK(appendEmptyBlock (&fh));
+  TEST_CHECK(closePageFile (&fh));
+
+  // reopen the file, the page count and contents follow the larger pages
+  TEST_CHECK(openPageFile (TESTPF, &fh));
+  ASSERT_TRUE((fh.totalNumPages == 3), "file has 3 pages of the custom size");
+  memset(ph, 0, pageSize);
+  TEST_CHECK(readBlock (1, &fh, ph));
+  for (i = 0; i < pageSize; i++)
+    ASSERT_TRUE((ph[i] == (i % 10) + '0'), "character in page read from disk is the one we expected.");
+  TEST_CHECK(readBlock (2, &fh, ph));
+  ASSERT_TRUE((ph[pageSize - 1] == 0), "appended page is empty");
+
+  TEST_CHECK(closePageFile (&fh));
+  TEST_CHECK(destroyPageFile (TESTPF));
+  free(ph);
+
+  TEST_DONE();
+}
+
+/* Try freeing and reusing pages, and root pages kept in the superblock */
+void
+testFreePages(void)
+{
+  SM_FileHandle fh;
+  SM_FileHandle others[130];
+  char fileName[64];
+  int pageNum, i;
+
+  testName = "test free page reuse and root pages";
+
+  TEST_CHECK(createPageFile (TESTPF));
+  TEST_CHECK(openPageFile (TESTPF, &fh));
+  ASSERT_TRUE((getRootPage(0, &fh) == SM_NO_ROOT_PAGE), "new file has no root pages");
+
+  // without free pages the file grows
+  TEST_CHECK(allocatePage (&fh, &pageNum));
+  ASSERT_TRUE((pageNum == 1), "first allocated page is appended");
+  TEST_CHECK(allocatePage (&fh, &pageNum));
+  TEST_CHECK(allocatePage (&fh, &pageNum));
+  ASSERT_TRUE((fh.totalNumPages == 4), "file grew to 4 pages");
+
+  TEST_CHECK(freePage (2, &fh));
+  TEST_CHECK(freePage (1, &fh));
+  ASSERT_TRUE((freePage (1, &fh) == RC_FREE_PAGE_FAILED), "freeing a free page should return an error");
+  ASSERT_ERROR(freePage (4, &fh), "freeing a non-existing page should return an error");
+  TEST_CHECK(setRootPage (0, 3, &fh));
+  TEST_CHECK(closePageFile (&fh));
+
+  // the free pages and root pages survive closing the file and are reused lowest first
+  TEST_CHECK(openPageFile (TESTPF, &fh));
+  ASSERT_TRUE((fh.totalNumPages == 4), "page count is read back from the superblock");
+  ASSERT_TRUE((getRootPage(0, &fh) == 3), "root page is read back from the superblock");
+  TEST_CHECK(allocatePage (&fh, &pageNum));
+  ASSERT_TRUE((pageNum == 1), "lowest free page is reused");
+  TEST_CHECK(allocatePage (&fh, &pageNum));
+  ASSERT_TRUE((pageNum == 2), "next free page is reused");
+  TEST_CHECK(allocatePage (&fh, &pageNum));
+  ASSERT_TRUE((pageNum == 4), "file grows once no page is free");
+  ASSERT_TRUE((fh.totalNumPages == 5), "file has 5 pages");
+
+  TEST_CHECK(closePageFile (&fh));
+
+  // a root page set after the descriptor of the file was closed to make room for others is still written back
+  TEST_CHECK(openPageFile (TESTPF, &fh));
+  for (i = 0; i < 65; i++)
+    {
+      sprintf(fileName, "test_pagefile_%i.bin", i);
+      TEST_CHECK(createPageFile (fileName));
+      TEST_CHECK(openPageFile (fileName, &others[i]));
+    }
+  TEST_CHECK(setRootPage (1, 2, &fh));
+  for (i = 0; i < 65; i++)
+    {
+      sprintf(fileName, "test_pagefile_%i.bin", i);
+      TEST_CHECK(openPageFile (fileName, &others[i + 65]));
+    }
+  TEST_CHECK(closePageFile (&fh));
+  TEST_CHECK(openPageFile (TESTPF, &fh));
+  ASSERT_TRUE((getRootPage(1, &fh) == 2), "root page set while other files were open is read back");
+  TEST_CHECK(closePageFile (&fh));
+  TEST_CHECK(destroyPageFile (TESTPF));
+  for (i = 0; i < 65; i++)
+    {
+      sprintf(fileName, "test_pagefile_%i.bin", i);
+      TEST_CHECK(closePageFile (&others[i]));
+      TEST_CHECK(closePageFile (&others[i + 65]));
+      TEST_CHECK(destroyPageFile (fileName));
+    }
+
+  TEST_DONE();
+}
+
+/* Try a checksummed page file and a page corrupted behind the storage manager's back */
+void
+testChecksums(void)
+{
+  SM_FileHandle fh;
+  SM_PageHandle ph;
+  FILE *file;
+  int i;
+
+  testName = "test page checksums";
+
+  ph = (SM_PageHandle) malloc(PAGE_SIZE);
+
+  TEST_CHECK(createPageFileWithFlags (TESTPF, PAGE_SIZE, SM_FILE_CHECKSUMS));
+  TEST_CHECK(openPageFile (TESTPF, &fh));
+
+  // the empty first page was never written and still reads fine
+  TEST_CHECK(readFirstBlock (&fh, ph));
+  for (i = 0; i < PAGE_SIZE; i++)
+    ph[i] = (i % 10) + '0';
+  TEST_CHECK(writeBlock (0, &fh, ph));
+  TEST_CHECK(appendEmptyBlock (&fh));
+  TEST_CHECK(readBlock (0, &fh, ph));
+  for (i = 0; i < PAGE_SIZE; i++)
+    ASSERT_TRUE((ph[i] == (i % 10) + '0'), "character in page read from disk is the one we expected.");
+  TEST_CHECK(closePageFile (&fh));
+
+  // flip one byte of page 0, which starts behind the superblock slot
+  file = fopen(TESTPF, "r+b");
+  fseek(file, PAGE_SIZE + 100, SEEK_SET);
+  fputc('x', file);
+  fclose(file);
+
+  TEST_CHECK(openPageFile (TESTPF, &fh));
+  ASSERT_TRUE((readBlock (0, &fh, ph) == RC_CHECKSUM_MISMATCH), "corrupted page is detected");
+  TEST_CHECK(readBlock (1, &fh, ph));
+  ASSERT_TRUE((ph[0] == 0), "appended page is empty");
+  TEST_CHECK(closePageFile (&fh));
+  TEST_CHECK(destroyPageFile (TESTPF));
+  free(ph);
+
+  TEST_DONE();
+}
+
+/* Try growing a page file through preallocated extents */
+void
+testPreallocation(void)
+{
+  SM_FileHandle fh;
+  SM_PageHandle ph;
+  struct stat fileStat;
+  int fd, numPages;
+
+  testName = "test file growth by preallocated extents";
+
+  ph = (SM_PageHandle) malloc(PAGE_SIZE);
+
+  TEST_CHECK(createPageFile (TESTPF));
+  TEST_CHECK(openPageFile (TESTPF, &fh));
+
+  TEST_CHECK(appendEmptyBlock (&fh));
+  ASSERT_TRUE((stat(TESTPF, &fileStat) == 0 && fileStat.st_size >= (1 << 20)), "appending a page preallocates a whole extent");
+  TEST_CHECK(ensureCapacity (100, &fh));
+  ASSERT_TRUE((fh.totalNumPages == 100), "file has 100 pages");
+  TEST_CHECK(readBlock (99, &fh, ph));
+  ASSERT_TRUE((ph[0] == 0 && ph[PAGE_SIZE - 1] == 0), "preallocated page is empty");
+
+  // the page count in the superblock is written once per extent, rounded up to its end, so opening the file after a crash drops no page
+  memset(ph, 'z', PAGE_SIZE);
+  TEST_CHECK(writeBlock (100, &fh, ph));
+  fd = open(TESTPF, O_RDONLY);
+  ASSERT_TRUE((fd >= 0 && pread(fd, &numPages, sizeof(int), 4 * sizeof(int)) == sizeof(int) && numPages > 101
+               && stat(TESTPF, &fileStat) == 0 && (off_t) (numPages + 1) * PAGE_SIZE <= fileStat.st_size),
+              "page count in the superblock is rounded up to the preallocated extent");
+  close(fd);
+  TEST_CHECK(closePageFile (&fh));
+  fd = open(TESTPF, O_RDONLY);
+  ASSERT_TRUE((fd >= 0 && pread(fd, &numPages, sizeof(int), 4 * sizeof(int)) == sizeof(int) && numPages == 101),
+              "closing the file writes the exact page count");
+  close(fd);
+  TEST_CHECK(destroyPageFile (TESTPF));
+
+  free(ph);
+
+  TEST_DONE();
+}